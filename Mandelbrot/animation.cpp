@@ -0,0 +1,316 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Zoom animation export for the OpenMP Mandelbrot renderer
+             Frames follow a keyframed camera path through an iterate, colorize and encode pipeline
+             whose stages run concurrently, connected by bounded queues
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "animation.h"
+#include "mariani_silver.h"
+#include "perturbation.h"
+
+namespace omp {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Hands items from one stage to the next, push blocks while the queue is full
+// close() ends the stream: consumers drain what is left, producers are turned away
+template <typename T>
+class BoundedQueue
+{
+	public:
+		explicit BoundedQueue(std::size_t capacity) : capacity(std::max<std::size_t>(capacity, 1)), closed(false) {}
+
+		// Returns: false if the queue was closed because a later stage stopped
+		bool push(T item)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			notFull.wait(lock, [&]() { return items.size() < capacity || closed; });
+			if (closed)
+			{
+				return false;
+			}
+			items.push_back(std::move(item));
+			notEmpty.notify_one();
+			return true;
+		}
+
+		// Returns: false once the queue is closed and empty
+		bool pop(T& item)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			notEmpty.wait(lock, [&]() { return !items.empty() || closed; });
+			if (items.empty())
+			{
+				return false;
+			}
+			item = std::move(items.front());
+			items.pop_front();
+			notFull.notify_one();
+			return true;
+		}
+
+		void close()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+			notFull.notify_all();
+			notEmpty.notify_all();
+		}
+
+	private:
+		std::mutex mutex;
+		std::condition_variable notFull;
+		std::condition_variable notEmpty;
+		std::deque<T> items;
+		std::size_t capacity;
+		bool closed;
+};
+
+struct IterationFrame
+{
+	std::shared_ptr<const FrameBuffer> frame;
+	int maxIterations;
+};
+
+// Float view of one frame, as used by mandelbrotSet
+struct FloatView
+{
+	float zoom;
+	float frame_x;
+	float frame_y;
+};
+
+// Colors iterations into the bytes of one video frame
+void encodePixels(const IterationFrame& input, VideoFormat format, const ColorOptions& colors, std::vector<uint8_t>& bytes)
+{
+	const FrameBuffer& frame = *input.frame;
+	const std::size_t plane = std::size_t(frame.width()) * frame.height();
+	std::vector<uint32_t> pixels(plane);
+	colorize(frame, pixels.data(), input.maxIterations, colors);
+	bytes.resize(plane * 3);
+	for (int y = 0; y < frame.height(); ++y)
+	{
+		for (int x = 0; x < frame.width(); ++x)
+		{
+			const std::size_t k = std::size_t(y) * frame.width() + x;
+			const uint32_t color = pixels[k];
+			const int r = int(color & 0xFF);
+			const int g = int((color >> 8) & 0xFF);
+			const int b = int((color >> 16) & 0xFF);
+			if (format == VideoFormat::RGB24)
+			{
+				bytes[3 * k] = uint8_t(r);
+				bytes[3 * k + 1] = uint8_t(g);
+				bytes[3 * k + 2] = uint8_t(b);
+			}
+			else
+			{
+				// BT.601 studio range, planar Y, Cb, Cr
+				bytes[k] = uint8_t(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+				bytes[plane + k] = uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+				bytes[2 * plane + k] = uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+			}
+		}
+	}
+}
+
+}  // namespace
+
+CameraPath::CameraPath(std::vector<Keyframe> keyframes) : keyframes(std::move(keyframes))
+{
+	std::stable_sort(this->keyframes.begin(), this->keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+}
+
+double CameraPath::start() const
+{
+	return keyframes.empty() ? 0.0 : keyframes.front().time;
+}
+
+double CameraPath::duration() const
+{
+	return keyframes.empty() ? 0.0 : keyframes.back().time - keyframes.front().time;
+}
+
+/**
+ * Interpolates the camera between the surrounding keyframes. The zoom follows
+ * z0 * (z1 / z0)^s, and the center moves by (z0 - z) / (z0 - z1) of the way, which keeps
+ * one point of the screen fixed while zooming, so a zoom into a target does not wobble.
+ *
+ * @param time seconds from the start of the animation
+ *
+ */
+Keyframe CameraPath::at(double time) const
+{
+	if (keyframes.empty())
+	{
+		return Keyframe();
+	}
+	if (time <= keyframes.front().time)
+	{
+		return keyframes.front();
+	}
+	if (time >= keyframes.back().time)
+	{
+		return keyframes.back();
+	}
+
+	const auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](double t, const Keyframe& key) { return t < key.time; });
+	const Keyframe& from = *(next - 1);
+	const Keyframe& to = *next;
+	const double s = (time - from.time) / (to.time - from.time);
+
+	Keyframe result;
+	result.time = time;
+	result.zoom = from.zoom * std::pow(to.zoom / from.zoom, s);
+	const double weight = (from.zoom == to.zoom) ? s : (from.zoom - result.zoom) / (from.zoom - to.zoom);
+
+	const int limbs = std::max({FixedPoint::limbsForZoom(result.zoom), from.real.precision(), to.real.precision(), from.imag.precision(), to.imag.precision()});
+	const FixedPoint w(limbs, weight);
+	result.real = from.real + (to.real - from.real) * w;
+	result.imag = from.imag + (to.imag - from.imag) * w;
+	return result;
+}
+
+/**
+ * Renders an animation through three stages running at the same time: the calling thread
+ * calculates iterations on the worker pool, a second thread colors them and a third writes
+ * the video. Bounded queues between the stages keep at most queueDepth frames in flight per
+ * queue, so a slow encoder throttles the renderer instead of buffering the whole video.
+ *
+ * @param job camera path, frame size, frame rate and format
+ * @param out receives the video, e.g. std::cout to pipe into an encoder
+ * @param stats optional output, frames and the busy time of each stage
+ * @param cancel optional flag, the animation stops after the frame being calculated
+ *
+ */
+bool renderAnimation(const AnimationJob& job, std::ostream& out, AnimationStats* stats, const std::atomic<bool>* cancel)
+{
+	if (job.width <= 0 || job.height <= 0 || job.fps <= 0)
+	{
+		return false;
+	}
+
+	const CameraPath path(job.keyframes);
+	const int frames = int(std::floor(path.duration() * job.fps + 1e-9)) + 1;
+	AnimationStats result;
+
+	BoundedQueue<IterationFrame> iterated(std::size_t(job.queueDepth));
+	BoundedQueue<std::vector<uint8_t>> colored(std::size_t(job.queueDepth));
+	std::atomic<bool> failed(false);
+
+	std::thread colorizer([&]()
+	{
+		IterationFrame input;
+		while (iterated.pop(input))
+		{
+			const Clock::time_point begin = Clock::now();
+			std::vector<uint8_t> bytes;
+			encodePixels(input, job.format, job.options.color, bytes);
+			result.colorSeconds += secondsSince(begin);
+			if (!colored.push(std::move(bytes)))
+			{
+				break;
+			}
+		}
+		iterated.close();
+		colored.close();
+	});
+
+	std::thread encoder([&]()
+	{
+		if (job.format == VideoFormat::Y4M)
+		{
+			out << "YUV4MPEG2 W" << job.width << " H" << job.height << " F" << job.fps << ":1 Ip A1:1 C444\n";
+		}
+		std::vector<uint8_t> bytes;
+		while (colored.pop(bytes))
+		{
+			const Clock::time_point begin = Clock::now();
+			if (job.format == VideoFormat::Y4M)
+			{
+				out << "FRAME\n";
+			}
+			out.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+			result.encodeSeconds += secondsSince(begin);
+			if (!out)
+			{
+				failed = true;
+				break;
+			}
+		}
+		out.flush();
+		failed = failed || !out;
+		colored.close();
+	});
+
+	bool completed = true;
+	for (int index = 0; index < frames && completed; ++index)
+	{
+		const Clock::time_point begin = Clock::now();
+		const Keyframe camera = path.at(path.start() + index / double(job.fps));
+		auto frame = std::make_shared<FrameBuffer>(job.width, job.height, job.options.color.smooth);
+		int maxIterations = MAX_ITERATIONS;
+
+		if (job.deep)
+		{
+			DeepView view;
+			view.zoom = camera.zoom;
+			view.maxIterations = maxIterations = deepIterationLimit(camera.zoom);
+			centerDeepView(view, camera.real, camera.imag, job.width, job.height);
+			completed = renderPerturbation(*frame, view, cancel);
+		}
+		else
+		{
+			// the camera center lands in the middle of the frame
+			FloatView view{float(camera.zoom), 0.f, 0.f};
+			RenderOptions options = job.options;
+			centerFrame(camera.real.toDouble(), camera.imag.toDouble(), job.width, job.height, view.zoom, view.frame_x, view.frame_y, options.formula);
+			// subdivision relies on properties of the Mandelbrot set
+			if (job.options.algorithm == Algorithm::MARIANI_SILVER && classicFormula(job.options.formula))
+			{
+				completed = marianiSilver(*frame, view.zoom, view.frame_x, view.frame_y, job.options, cancel);
+			}
+			else
+			{
+				completed = renderRegion(*frame, 0, 0, job.width, job.height, view.zoom, view.frame_x, view.frame_y, options, cancel);
+			}
+		}
+		result.iterateSeconds += secondsSince(begin);
+
+		completed = completed && iterated.push(IterationFrame{frame, maxIterations});
+		result.frames += completed ? 1 : 0;
+	}
+
+	iterated.close();
+	colorizer.join();
+	encoder.join();
+
+	if (stats != nullptr)
+	{
+		*stats = result;
+	}
+	return completed && !failed;
+}
+
+}  // namespace omp
@@ -0,0 +1,80 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Zoom animation export for the OpenMP Mandelbrot renderer
+             Frames follow a keyframed camera path through an iterate, colorize and encode pipeline
+             whose stages run concurrently, connected by bounded queues
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "fixed_point.h"
+#include "mandelbrot_omp.h"
+
+namespace omp {
+
+    // Camera position at a point in time, the center is the point in the middle of the frame
+    struct Keyframe
+    {
+        double time = 0.0;  // seconds from the start of the animation
+        FixedPoint real;
+        FixedPoint imag;
+        double zoom = 1.0;
+    };
+
+    // Interpolates keyframes: zoom changes exponentially (a constant zoom speed) and the center
+    // moves so the zoom happens about a fixed point of the screen
+    class CameraPath
+    {
+        public:
+            // Keyframes are sorted by time, an empty path stays at the default view
+            explicit CameraPath(std::vector<Keyframe> keyframes);
+
+            double start() const;  // time of the first keyframe
+            double duration() const;
+
+            // Returns the camera at time, clamped to the first and last keyframe
+            Keyframe at(double time) const;
+
+        private:
+            std::vector<Keyframe> keyframes;
+    };
+
+    enum class VideoFormat
+    {
+        Y4M,   // YUV4MPEG2, 4:4:4 BT.601, readable by ffmpeg and most encoders
+        RGB24  // headerless packed RGB frames
+    };
+
+    struct AnimationJob
+    {
+        std::vector<Keyframe> keyframes;
+        int width = 1280;
+        int height = 720;
+        int fps = 30;
+        VideoFormat format = VideoFormat::Y4M;
+        RenderOptions options;  // kernel, tile size and interior checks of float frames
+        bool deep = false;      // render every frame with perturbation, needed once the path zooms past float precision
+        int queueDepth = 2;     // frames waiting between two stages at most
+    };
+
+    struct AnimationStats
+    {
+        int frames = 0;
+        double iterateSeconds = 0.0;  // busy time of each stage, they overlap
+        double colorSeconds = 0.0;
+        double encodeSeconds = 0.0;
+    };
+
+    // Renders every frame of the path and writes the video to out
+    // Returns: false if writing failed or the render was cancelled
+    bool renderAnimation(const AnimationJob& job, std::ostream& out, AnimationStats* stats = nullptr, const std::atomic<bool>* cancel = nullptr);
+
+}  // namespace omp
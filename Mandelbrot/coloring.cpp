@@ -0,0 +1,308 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Coloring pass of the OpenMP renderer, separate from iterating
+             Counts are looked up in precomputed palette tables, optionally with smooth counts and
+             histogram equalization, so a finished frame can be recolored without iterating again
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "coloring.h"
+#include "mandelbrot_omp.h"
+#include "trace.h"
+
+namespace omp {
+
+namespace {
+
+constexpr int gradientSize = 1024;  // entries of a palette table, positions are indices into it
+constexpr int colorRows = 16;       // rows per work unit of the coloring pass
+constexpr uint32_t black = 0xFFu << 24;
+
+// Color at a position of a piecewise linear palette
+struct Stop
+{
+	float position;
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+};
+
+const Stop fireStops[] = {{0.0f, 0, 0, 0}, {0.3f, 180, 20, 0}, {0.55f, 255, 120, 0}, {0.8f, 255, 230, 40}, {1.0f, 255, 255, 255}};
+const Stop oceanStops[] = {{0.0f, 0, 7, 40}, {0.4f, 20, 60, 180}, {0.75f, 60, 210, 230}, {1.0f, 255, 255, 255}};
+const Stop grayStops[] = {{0.0f, 0, 0, 0}, {1.0f, 255, 255, 255}};
+
+const char* const paletteNames[] = {"classic", "fire", "ocean", "grayscale", "sine"};
+
+uint32_t pack(int r, int g, int b)
+{
+	return black | uint32_t(r) | (uint32_t(g) << 8) | (uint32_t(b) << 16);
+}
+
+// Returns: the palette color at t, interpolated between the stops around it
+uint32_t interpolate(const Stop* stops, int count, float t)
+{
+	int k = 1;
+	while (k < count - 1 && stops[k].position < t)
+	{
+		++k;
+	}
+	const Stop& a = stops[k - 1];
+	const Stop& b = stops[k];
+	const float f = std::min(std::max((t - a.position) / (b.position - a.position), 0.0f), 1.0f);
+	return pack(int(std::lround(a.r + f * (b.r - a.r))), int(std::lround(a.g + f * (b.g - a.g))), int(std::lround(a.b + f * (b.b - a.b))));
+}
+
+// Returns: the gradientSize entry table of a palette, built once on first use
+const std::vector<uint32_t>& gradient(Palette palette)
+{
+	static const std::array<std::vector<uint32_t>, paletteCount> tables = []()
+	{
+		std::array<std::vector<uint32_t>, paletteCount> result;
+		for (int p = 0; p < paletteCount; ++p)
+		{
+			result[p].resize(gradientSize);
+			for (int k = 0; k < gradientSize; ++k)
+			{
+				result[p][k] = paletteColor(static_cast<Palette>(p), k / float(gradientSize - 1));
+			}
+		}
+		return result;
+	}();
+	return tables[static_cast<int>(palette)];
+}
+
+// Positions spread evenly over the counts, count / maxIterations of the table
+void linearPositions(int maxIterations, std::vector<float>& positions)
+{
+	for (int count = 0; count <= maxIterations; ++count)
+	{
+		positions[count] = count * float(gradientSize - 1) / maxIterations;
+	}
+}
+
+/**
+ * Places every count by the share of escaped pixels with a lower count. Each worker counts
+ * a band of rows into its own histogram, then the histograms are summed and scanned in
+ * parallel: every range of counts is scanned on its own, the range totals are scanned
+ * (there are only a few) and each range adds the total of the ranges before it.
+ *
+ * @param frame calculated iterations
+ * @param maxIterations iteration limit, pixels at the limit are inside the set and not counted
+ * @param positions receives the position of each count 0..maxIterations
+ *
+ */
+void equalizedPositions(const FrameBuffer& frame, int maxIterations, std::vector<float>& positions)
+{
+	TileScheduler& pool = TileScheduler::instance();
+	const int bins = maxIterations;
+	const int bands = std::max(1, std::min<int>(pool.threadCount(), frame.height()));
+	const int bandRows = (frame.height() + bands - 1) / std::max(bands, 1);
+	std::vector<uint32_t> histograms(std::size_t(bands) * bins, 0);
+
+	std::vector<Tile> rows;
+	for (int y = 0; y < frame.height(); y += bandRows)
+	{
+		rows.push_back(Tile{0, y, frame.width(), std::min(bandRows, frame.height() - y), 0});
+	}
+	pool.run(std::move(rows), [&](const Tile& tile)
+	{
+		uint32_t* histogram = histograms.data() + std::size_t(tile.y / bandRows) * bins;
+		for (int y = tile.y; y < tile.y + tile.height; ++y)
+		{
+			const uint16_t* row = frame.row(y);
+			for (int x = 0; x < tile.width; ++x)
+			{
+				if (row[x] < bins)
+				{
+					++histogram[row[x]];
+				}
+			}
+		}
+	});
+
+	// below[count] is the number of pixels with a lower count, first within its range, then overall
+	const int ranges = std::max(1, std::min(bands, bins));
+	const int rangeBins = (bins + ranges - 1) / ranges;
+	std::vector<uint64_t> below(std::size_t(bins) + 1, 0);
+	std::vector<uint64_t> rangeTotals(ranges, 0);
+	std::vector<Tile> binRanges;
+	for (int first = 0; first < bins; first += rangeBins)
+	{
+		binRanges.push_back(Tile{first, 0, std::min(rangeBins, bins - first), 1, 0});
+	}
+	pool.run(binRanges, [&](const Tile& range)
+	{
+		uint64_t sum = 0;
+		for (int count = range.x; count < range.x + range.width; ++count)
+		{
+			below[count] = sum;
+			for (int band = 0; band < bands; ++band)
+			{
+				sum += histograms[std::size_t(band) * bins + count];
+			}
+		}
+		rangeTotals[range.x / rangeBins] = sum;
+	});
+
+	std::vector<uint64_t> rangeOffsets(ranges, 0);
+	uint64_t total = 0;
+	for (int range = 0; range < ranges; ++range)
+	{
+		rangeOffsets[range] = total;
+		total += rangeTotals[range];
+	}
+
+	const float scale = (total > 0) ? float(gradientSize - 1) / float(total) : 0.0f;
+	pool.run(binRanges, [&](const Tile& range)
+	{
+		const uint64_t offset = rangeOffsets[range.x / rangeBins];
+		for (int count = range.x; count < range.x + range.width; ++count)
+		{
+			positions[count] = float(below[count] + offset) * scale;
+		}
+	});
+	positions[bins] = float(gradientSize - 1);
+}
+
+}  // namespace
+
+/**
+ * Evaluates a palette. Only used to fill the palette tables, the coloring pass looks colors up.
+ *
+ * @param palette which palette
+ * @param t position in [0, 1], 0 for the lowest count
+ *
+ */
+uint32_t paletteColor(Palette palette, float t)
+{
+	t = std::min(std::max(t, 0.0f), 1.0f);
+	switch (palette)
+	{
+		case Palette::FIRE:
+			return interpolate(fireStops, int(sizeof(fireStops) / sizeof(fireStops[0])), t);
+		case Palette::OCEAN:
+			return interpolate(oceanStops, int(sizeof(oceanStops) / sizeof(oceanStops[0])), t);
+		case Palette::GRAYSCALE:
+			return interpolate(grayStops, int(sizeof(grayStops) / sizeof(grayStops[0])), t);
+		case Palette::SINE:
+		{
+			// glColor3f clamps the negative half of each wave to 0
+			const auto channel = [t](float phase) { return int(std::lround(255.0f * std::max(0.0f, std::sin(6.3f * t + phase)))); };
+			return pack(channel(5.0f), channel(3.0f), channel(1.0f));
+		}
+		case Palette::CLASSIC:
+		default:
+		{
+			const int intensity = int(std::lround(255.0f * t));
+			return pack(intensity, intensity, 0);  // yellow scaled on [0,1]
+		}
+	}
+}
+
+const char* paletteName(Palette palette)
+{
+	const int index = static_cast<int>(palette);
+	return (index >= 0 && index < paletteCount) ? paletteNames[index] : "unknown";
+}
+
+bool parsePalette(const char* name, Palette& palette)
+{
+	for (int index = 0; index < paletteCount; ++index)
+	{
+		if (std::strcmp(name, paletteNames[index]) == 0)
+		{
+			palette = static_cast<Palette>(index);
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Colors the iterations calculated by mandelbrotSet into a pixel buffer. The palette is
+ * resolved into a table with one color per count first, so the per-pixel work is a table
+ * lookup (plus an interpolation for smooth counts). Recoloring only repeats this pass.
+ *
+ * @param frame iteration buffer filled by mandelbrotSet
+ * @param pixels width*height packed RGBA pixels, row 0 is the top of the frame
+ * @param maxIterations iteration limit the frame was calculated with
+ * @param color palette, smooth counts and histogram equalization
+ *
+ */
+void colorize(const FrameBuffer& frame, uint32_t* pixels, int maxIterations, const ColorOptions& color)
+{
+	TRACE_SCOPE("colorize");
+	const int width = frame.width();
+	if (width <= 0 || frame.height() <= 0 || maxIterations <= 0)
+	{
+		return;
+	}
+
+	// positions[count] is where a count sits in the palette table, smooth counts interpolate to the next count
+	std::vector<float> positions(std::size_t(maxIterations) + 1);
+	if (color.histogram)
+	{
+		equalizedPositions(frame, maxIterations, positions);
+	}
+	else
+	{
+		linearPositions(maxIterations, positions);
+	}
+
+	const std::vector<uint32_t>& table = gradient(color.palette);
+	std::vector<uint32_t> colors(std::size_t(maxIterations) + 1);
+	for (int count = 0; count < maxIterations; ++count)
+	{
+		// the classic ramp keeps the exact rounding of getColor
+		colors[count] = (color.palette == Palette::CLASSIC && !color.histogram) ? getColor(count, maxIterations) : table[int(positions[count] + 0.5f)];
+	}
+	colors[maxIterations] = black;
+
+	const bool smooth = color.smooth && frame.hasSmooth();
+	const uint16_t limit = uint16_t(maxIterations);
+	std::vector<Tile> strips;
+	for (int y = 0; y < frame.height(); y += colorRows)
+	{
+		strips.push_back(Tile{0, y, width, std::min(colorRows, frame.height() - y), 0});
+	}
+	TileScheduler::instance().run(std::move(strips), [&](const Tile& strip)
+	{
+		for (int iy = strip.y; iy < strip.y + strip.height; ++iy)
+		{
+			const uint16_t* row = frame.row(iy);
+			uint32_t* pixel_row = pixels + std::size_t(iy) * width;
+			if (!smooth)
+			{
+				for (int ix = 0; ix < width; ++ix)
+				{
+					pixel_row[ix] = colors[std::min(row[ix], limit)];
+				}
+				continue;
+			}
+
+			const float* smooth_row = frame.smoothRow(iy);
+			for (int ix = 0; ix < width; ++ix)
+			{
+				const int count = std::min(row[ix], limit);
+				if (count >= maxIterations)
+				{
+					pixel_row[ix] = black;
+					continue;
+				}
+				const float fraction = std::min(std::max(smooth_row[ix] - count, 0.0f), 1.0f);
+				const float position = positions[count] + fraction * (positions[count + 1] - positions[count]);
+				pixel_row[ix] = table[int(position + 0.5f)];
+			}
+		}
+	});
+}
+
+}  // namespace omp
@@ -0,0 +1,48 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Coloring pass of the OpenMP renderer, separate from iterating
+             Counts are looked up in precomputed palette tables, optionally with smooth counts and
+             histogram equalization, so a finished frame can be recolored without iterating again
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace omp {
+
+    enum class Palette
+    {
+        CLASSIC,    // the original black to yellow ramp of getColor
+        FIRE,       // black, red, orange, yellow, white
+        OCEAN,      // navy, blue, cyan, white
+        GRAYSCALE,
+        SINE        // phase shifted sine waves per channel, the set_color ramp of the CUDA renderer
+    };
+
+    constexpr int paletteCount = 5;
+
+    // How counts are turned into colors, the default reproduces getColor exactly
+    struct ColorOptions
+    {
+        Palette palette = Palette::CLASSIC;
+        bool smooth = false;     // color by the fractional counts of the frame's smooth channel, frames without one use integer counts
+        bool histogram = false;  // histogram equalization: each count is placed by the share of escaped pixels below it
+
+        bool operator==(const ColorOptions& other) const { return palette == other.palette && smooth == other.smooth && histogram == other.histogram; }
+        bool operator!=(const ColorOptions& other) const { return !(*this == other); }
+    };
+
+    // Packed RGBA color (red in the low byte) of the palette at position t in [0, 1]
+    uint32_t paletteColor(Palette palette, float t);
+
+    // Human readable palette name, also accepted by parsePalette
+    const char* paletteName(Palette palette);
+
+    // Returns: true if name is one of the palette names, the palette goes to palette
+    bool parsePalette(const char* name, Palette& palette);
+
+}  // namespace omp
@@ -0,0 +1,243 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Arbitrary precision fixed-point numbers for the deep zoom reference orbit
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "fixed_point.h"
+
+namespace omp {
+
+namespace {
+
+// Compares two magnitudes of the same length, returns <0, 0 or >0
+int compareMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+{
+	for (std::size_t k = 0; k < a.size(); ++k)
+	{
+		if (a[k] != b[k])
+		{
+			return (a[k] < b[k]) ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+}  // namespace
+
+/**
+ * Creates a number from a double. Doubles are binary fractions, so the conversion is exact
+ * as long as the number has enough limbs.
+ *
+ * @param limbs total number of limbs including the integer limb, at least 2
+ * @param value initial value, |value| < 2^32
+ *
+ */
+FixedPoint::FixedPoint(int limbs, double value) : negative(value < 0.0), limbs(std::size_t(std::max(limbs, 2)), 0u)
+{
+	double magnitude = std::fabs(value);
+	for (uint32_t& limb : this->limbs)
+	{
+		const double whole = std::floor(magnitude);
+		limb = uint32_t(whole);
+		magnitude = std::ldexp(magnitude - whole, 32);
+		if (magnitude == 0.0)
+		{
+			break;
+		}
+	}
+}
+
+int FixedPoint::limbsForZoom(double zoom)
+{
+	const double bits = std::log2(1.0 / std::min(std::max(zoom, 1e-300), 1.0)) + 64.0;
+	return 1 + int(std::ceil(bits / 32.0));
+}
+
+/**
+ * Reads the fraction digits from the last one, x = (x + digit) / 10, so every digit is
+ * exact up to the truncation of one division per digit.
+ *
+ * @param text optional sign, integer digits, optional '.' and fraction digits
+ * @param limbs total number of limbs of the result
+ * @param value receives the number
+ *
+ */
+bool FixedPoint::parse(const std::string& text, int limbs, FixedPoint& value)
+{
+	std::size_t position = 0;
+	const bool negative = !text.empty() && (text[0] == '-' || text[0] == '+') ? text[position++] == '-' : false;
+	const std::size_t point = text.find('.', position);
+	const std::string whole = text.substr(position, (point == std::string::npos) ? std::string::npos : point - position);
+	const std::string fraction = (point == std::string::npos) ? std::string() : text.substr(point + 1);
+	const auto digits = [](const std::string& part) { return part.find_first_not_of("0123456789") == std::string::npos; };
+	if ((whole.empty() && fraction.empty()) || !digits(whole) || !digits(fraction) || whole.size() > 9)
+	{
+		return false;
+	}
+
+	FixedPoint result(limbs);
+	for (auto digit = fraction.rbegin(); digit != fraction.rend(); ++digit)
+	{
+		result.limbs[0] += uint32_t(*digit - '0');
+		result.divideMagnitude(10);
+	}
+	result.limbs[0] = whole.empty() ? 0u : uint32_t(std::stoul(whole));
+	result.negative = negative && !result.isZero();
+	value = result;
+	return true;
+}
+
+void FixedPoint::setPrecision(int limbs)
+{
+	this->limbs.resize(std::size_t(std::max(limbs, 2)), 0u);
+}
+
+double FixedPoint::toDouble() const
+{
+	// three limbs from the leading nonzero one already carry more bits than a double holds
+	int first = 0;
+	while (first + 1 < int(limbs.size()) && limbs[first] == 0)
+	{
+		++first;
+	}
+	double value = 0.0;
+	for (int k = std::min(int(limbs.size()), first + 3) - 1; k >= first; --k)
+	{
+		value += std::ldexp(double(limbs[k]), -32 * k);
+	}
+	return negative ? -value : value;
+}
+
+bool FixedPoint::isZero() const
+{
+	return std::all_of(limbs.begin(), limbs.end(), [](uint32_t limb) { return limb == 0; });
+}
+
+/**
+ * Adds or subtracts the magnitude of other, the sign follows the larger magnitude.
+ *
+ * @param other number to add, extended or truncated to this precision
+ * @param subtract true to subtract other instead of adding it
+ *
+ */
+void FixedPoint::addMagnitude(const FixedPoint& other, bool subtract)
+{
+	if (other.limbs.size() > limbs.size())
+	{
+		this->setPrecision(int(other.limbs.size()));
+	}
+	std::vector<uint32_t> rhs(other.limbs.begin(), other.limbs.begin() + std::min(other.limbs.size(), limbs.size()));
+	rhs.resize(limbs.size(), 0u);
+
+	const bool otherNegative = other.negative != subtract;
+	if (negative == otherNegative)
+	{
+		uint64_t carry = 0;
+		for (int k = int(limbs.size()) - 1; k >= 0; --k)
+		{
+			const uint64_t sum = uint64_t(limbs[k]) + rhs[k] + carry;
+			limbs[k] = uint32_t(sum);
+			carry = sum >> 32;
+		}
+		return;
+	}
+
+	// signs differ: subtract the smaller magnitude from the larger one
+	std::vector<uint32_t> lhs = limbs;
+	if (compareMagnitude(lhs, rhs) < 0)
+	{
+		std::swap(lhs, rhs);
+		negative = otherNegative;
+	}
+	int64_t borrow = 0;
+	for (int k = int(limbs.size()) - 1; k >= 0; --k)
+	{
+		int64_t difference = int64_t(lhs[k]) - rhs[k] - borrow;
+		borrow = (difference < 0) ? 1 : 0;
+		limbs[k] = uint32_t(difference + (borrow << 32));
+	}
+	if (this->isZero())
+	{
+		negative = false;
+	}
+}
+
+FixedPoint& FixedPoint::operator+=(const FixedPoint& other)
+{
+	this->addMagnitude(other, false);
+	return *this;
+}
+
+FixedPoint& FixedPoint::operator-=(const FixedPoint& other)
+{
+	this->addMagnitude(other, true);
+	return *this;
+}
+
+/**
+ * Schoolbook multiplication, the product is truncated to the longer of the two precisions.
+ * Each row of partial products is accumulated from the least significant limb so every
+ * carry lands in a limb no earlier row has touched yet.
+ *
+ * @param other factor
+ *
+ */
+FixedPoint& FixedPoint::operator*=(const FixedPoint& other)
+{
+	const std::size_t n = std::max(limbs.size(), other.limbs.size());
+	std::vector<uint32_t> a = limbs;
+	std::vector<uint32_t> b = other.limbs;
+	a.resize(n, 0u);
+	b.resize(n, 0u);
+
+	std::vector<uint32_t> product(2 * n - 1, 0u);
+	for (int i = int(n) - 1; i >= 0; --i)
+	{
+		if (a[i] == 0)
+		{
+			continue;
+		}
+		uint64_t carry = 0;
+		for (int j = int(n) - 1; j >= 0; --j)
+		{
+			const uint64_t term = uint64_t(a[i]) * b[j] + product[i + j] + carry;
+			product[i + j] = uint32_t(term);
+			carry = term >> 32;
+		}
+		if (i > 0)
+		{
+			product[i - 1] = uint32_t(carry);  // the integer limb overflows only for values >= 2^32
+		}
+	}
+
+	limbs.assign(product.begin(), product.begin() + n);
+	negative = (negative != other.negative) && !this->isZero();
+	return *this;
+}
+
+// Long division of the magnitude by a small integer, from the integer limb down
+void FixedPoint::divideMagnitude(uint32_t divisor)
+{
+	uint64_t remainder = 0;
+	for (uint32_t& limb : limbs)
+	{
+		const uint64_t current = (remainder << 32) | limb;
+		limb = uint32_t(current / divisor);
+		remainder = current % divisor;
+	}
+}
+
+FixedPoint FixedPoint::operator-() const
+{
+	FixedPoint result = *this;
+	result.negative = !negative && !this->isZero();
+	return result;
+}
+
+}  // namespace omp
@@ -0,0 +1,55 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Arbitrary precision fixed-point numbers for the deep zoom reference orbit
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace omp {
+
+    // Sign-magnitude fixed-point number: one 32-bit integer limb followed by 32-bit fraction limbs
+    // Values must stay below 2^32 in magnitude, which holds for every orbit that has not escaped
+    class FixedPoint
+    {
+        public:
+            explicit FixedPoint(int limbs = 2, double value = 0.0);
+
+            // Number of limbs needed to resolve a pixel of a view zoom wide, with 64 guard bits
+            static int limbsForZoom(double zoom);
+
+            // Parses a plain decimal such as "-0.7436438870371587047521915" digit by digit, without rounding through double
+            // Returns: false if text is not a decimal number below 2^32 in magnitude
+            static bool parse(const std::string& text, int limbs, FixedPoint& value);
+
+            // Changes the number of fraction limbs, extra limbs are zero, dropped limbs are truncated
+            void setPrecision(int limbs);
+            int precision() const { return int(limbs.size()); }
+
+            double toDouble() const;
+            bool isZero() const;
+
+            FixedPoint& operator+=(const FixedPoint& other);
+            FixedPoint& operator-=(const FixedPoint& other);
+            FixedPoint& operator*=(const FixedPoint& other);
+            FixedPoint operator-() const;
+
+            friend FixedPoint operator+(FixedPoint lhs, const FixedPoint& rhs) { return lhs += rhs; }
+            friend FixedPoint operator-(FixedPoint lhs, const FixedPoint& rhs) { return lhs -= rhs; }
+            friend FixedPoint operator*(FixedPoint lhs, const FixedPoint& rhs) { return lhs *= rhs; }
+
+        private:
+            bool negative;
+            std::vector<uint32_t> limbs;  // limbs[0] is the integer part, limbs[k] has weight 2^(-32k)
+
+            void addMagnitude(const FixedPoint& other, bool subtract);
+            void divideMagnitude(uint32_t divisor);
+    };
+
+}  // namespace omp
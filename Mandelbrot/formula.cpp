@@ -0,0 +1,194 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Escape-time kernels for the OpenMP renderer generated from formula policies
+             Every combination of formula and scalar type is its own instantiation,
+             so the inner loop is inlined without runtime branches
+*/
+
+#include <cmath>
+#include <cstring>
+
+#include "formula.h"
+#include "mandelbrot_omp.h"
+
+namespace omp {
+
+namespace {
+
+// Float coordinates come from the shared mapping so they match the other kernels, double ones use the same expression
+// in double around the unrounded frame_x + frame_x_lo
+template <typename Real>
+Real mapReal(int i, int width, float zoom, float frame_x, double frame_x_lo)
+{
+	if (sizeof(Real) == sizeof(float))
+	{
+		return pixelToReal(i, width, zoom, frame_x);
+	}
+	return ((i / Real(width) - Real(0.5)) * zoom + (Real(frame_x) + Real(frame_x_lo))) * Real(5);
+}
+
+template <typename Real>
+Real mapImag(int j, int height, float zoom, float frame_y, double frame_y_lo)
+{
+	if (sizeof(Real) == sizeof(float))
+	{
+		return pixelToImag(j, height, zoom, frame_y);
+	}
+	return ((j / Real(height) - Real(0.5)) * zoom - (Real(frame_y) + Real(frame_y_lo))) * Real(5);
+}
+
+// Normalized iteration count for z^degree + c, the degree 2 case is smoothIterations itself
+template <int Degree>
+float smoothCount(int iterations, float mag_sq)
+{
+	if (Degree == 2 || iterations >= MAX_ITERATIONS)
+	{
+		return smoothIterations(iterations, mag_sq, MAX_ITERATIONS);
+	}
+	return iterations + 1.0f - std::log2(0.5f * std::log2(mag_sq)) / std::log2(float(Degree));
+}
+
+/**
+ * Calculates a row segment with one instantiation of the escape-time loop. Everything that
+ * depends on the formula is resolved at compile time.
+ *
+ * @param formula Julia constant used by the Julia formula, low parts of the view center in double precision
+ * @param iterations receives count counts
+ * @param smooth optional, receives count smooth counts
+ * @param i first column
+ * @param j row
+ * @param step column spacing of the samples
+ *
+ */
+template <typename Policy, typename Real>
+uint64_t formulaRowOf(const FormulaOptions& formula, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step)
+{
+	const Real imag = mapImag<Real>(j, height, zoom, frame_y, formula.frame_y_lo);
+	const Real julia_real = Real(formula.julia_real);
+	const Real julia_imag = Real(formula.julia_imag);
+	uint64_t executed = 0;
+	for (int k = 0; k < count; ++k)
+	{
+		const Real real = mapReal<Real>(i + k * step, width, zoom, frame_x, formula.frame_x_lo);
+		Real mag_sq = Real(0);
+		const int escaped = Policy::julia ? escapeTime<Policy, Real>(real, imag, julia_real, julia_imag, MAX_ITERATIONS, mag_sq, executed)
+		                                  : escapeTime<Policy, Real>(real, imag, real, imag, MAX_ITERATIONS, mag_sq, executed);
+		iterations[k] = uint16_t(escaped);
+		if (smooth != nullptr)
+		{
+			smooth[k] = smoothCount<Policy::degree>(escaped, float(mag_sq));
+		}
+	}
+	return executed;
+}
+
+typedef uint64_t (*RowFunction)(const FormulaOptions&, uint16_t*, float*, int, int, int, int, int, float, float, float, int);
+
+template <typename Policy>
+RowFunction rowFunction(const FormulaOptions& formula)
+{
+	return formula.doublePrecision ? formulaRowOf<Policy, double> : formulaRowOf<Policy, float>;
+}
+
+const char* const formulaNames[] = {"mandelbrot", "julia", "multibrot3", "multibrot4", "burning-ship", "tricorn"};
+
+}  // namespace
+
+/**
+ * Picks the instantiation once per row segment, so the per-pixel loop has no formula dispatch.
+ *
+ * @param formula formula, precision and Julia constant
+ * @param iterations receives count counts
+ * @param smooth optional, receives count smooth counts
+ * @param i first column
+ * @param j row
+ * @param count number of samples
+ * @param width of fractal in pixels
+ * @param height of fractal in pixels
+ * @param zoom scaling factor of fractal
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param step column spacing of the samples
+ *
+ */
+uint64_t formulaRow(const FormulaOptions& formula, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step)
+{
+	RowFunction row = nullptr;
+	switch (formula.type)
+	{
+		case Formula::JULIA:
+			row = rowFunction<JuliaFormula>(formula);
+			break;
+		case Formula::MULTIBROT3:
+			row = rowFunction<MultibrotFormula<3>>(formula);
+			break;
+		case Formula::MULTIBROT4:
+			row = rowFunction<MultibrotFormula<4>>(formula);
+			break;
+		case Formula::BURNING_SHIP:
+			row = rowFunction<BurningShipFormula>(formula);
+			break;
+		case Formula::TRICORN:
+			row = rowFunction<TricornFormula>(formula);
+			break;
+		case Formula::MANDELBROT:
+		default:
+			row = rowFunction<MandelbrotFormula>(formula);
+			break;
+	}
+	return row(formula, iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step);
+}
+
+/**
+ * Mirroring relies on pixelToImag negating exactly, which only holds for the float mapping.
+ *
+ * @param formula formula and precision of the view
+ *
+ */
+bool formulaMirrorsRows(const FormulaOptions& formula)
+{
+	if (formula.doublePrecision)
+	{
+		return false;
+	}
+	switch (formula.type)
+	{
+		case Formula::MANDELBROT:
+			return MandelbrotFormula::mirrorsRows;
+		case Formula::JULIA:
+			return JuliaFormula::mirrorsRows;
+		case Formula::MULTIBROT3:
+			return MultibrotFormula<3>::mirrorsRows;
+		case Formula::MULTIBROT4:
+			return MultibrotFormula<4>::mirrorsRows;
+		case Formula::BURNING_SHIP:
+			return BurningShipFormula::mirrorsRows;
+		case Formula::TRICORN:
+			return TricornFormula::mirrorsRows;
+	}
+	return false;
+}
+
+const char* formulaName(Formula formula)
+{
+	const int index = static_cast<int>(formula);
+	return (index >= 0 && index < int(sizeof(formulaNames) / sizeof(formulaNames[0]))) ? formulaNames[index] : "unknown";
+}
+
+bool parseFormula(const char* name, Formula& formula)
+{
+	for (int index = 0; index < int(sizeof(formulaNames) / sizeof(formulaNames[0])); ++index)
+	{
+		if (std::strcmp(name, formulaNames[index]) == 0)
+		{
+			formula = static_cast<Formula>(index);
+			return true;
+		}
+	}
+	return false;
+}
+
+}  // namespace omp
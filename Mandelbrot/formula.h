@@ -0,0 +1,164 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Escape-time kernels for the OpenMP renderer generated from formula policies
+             Every combination of formula and scalar type is its own instantiation,
+             so the inner loop is inlined without runtime branches
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace omp {
+
+    enum class Formula
+    {
+        MANDELBROT,    // z^2 + c, z starts at c
+        JULIA,         // z^2 + k for a fixed k, z starts at the pixel
+        MULTIBROT3,    // z^3 + c
+        MULTIBROT4,    // z^4 + c
+        BURNING_SHIP,  // (|Re z| + i|Im z|)^2 + c
+        TRICORN        // conj(z)^2 + c
+    };
+
+    // Formula the CPU renderer iterates, the default is the original float Mandelbrot loop
+    struct FormulaOptions
+    {
+        Formula type = Formula::MANDELBROT;
+        bool doublePrecision = false;  // map pixels and iterate in double, for zooms past float precision
+        double frame_x_lo = 0.0;       // double precision only: frame_x + frame_x_lo is the view center the pixels are mapped around
+        double frame_y_lo = 0.0;       // (see centerFrame), a float frame_x alone is off by hundreds of view widths below zoom 1e-9
+        double julia_real = 0.355534;  // k of the Julia formula, the constant julia.frag uses
+        double julia_imag = -0.337292;
+
+        bool operator==(const FormulaOptions& other) const
+        {
+            return type == other.type && doublePrecision == other.doublePrecision && frame_x_lo == other.frame_x_lo && frame_y_lo == other.frame_y_lo
+                && julia_real == other.julia_real && julia_imag == other.julia_imag;
+        }
+        bool operator!=(const FormulaOptions& other) const { return !(*this == other); }
+    };
+
+    // -formula policies- //
+    // step advances z once, degree is the power of z used by smooth coloring, julia starts z at the pixel and
+    // iterates with the fixed k, mirrorsRows is set if conjugate pixels have the same counts
+
+    struct MandelbrotFormula
+    {
+        static constexpr int degree = 2;
+        static constexpr bool julia = false;
+        static constexpr bool mirrorsRows = true;
+
+        // Same operations in the same order as getIterations, so float counts match it bit for bit
+        template <typename Real>
+        static void step(Real& real, Real& imag, Real const_real, Real const_imag)
+        {
+            const Real temp_real = real;
+            real = (real * real - imag * imag) + const_real;
+            imag = (Real(2) * temp_real * imag) + const_imag;
+        }
+    };
+
+    struct JuliaFormula : MandelbrotFormula
+    {
+        static constexpr bool julia = true;
+        static constexpr bool mirrorsRows = false;  // only for a real k
+    };
+
+    template <int N>
+    struct MultibrotFormula
+    {
+        static_assert(N >= 2, "multibrot degree must be at least 2");
+        static constexpr int degree = N;
+        static constexpr bool julia = false;
+        static constexpr bool mirrorsRows = true;
+
+        template <typename Real>
+        static void step(Real& real, Real& imag, Real const_real, Real const_imag)
+        {
+            Real power_real = real;
+            Real power_imag = imag;
+            for (int k = 1; k < N; ++k)  // constant trip count, unrolled by the compiler
+            {
+                const Real temp_real = power_real;
+                power_real = power_real * real - power_imag * imag;
+                power_imag = temp_real * imag + power_imag * real;
+            }
+            real = power_real + const_real;
+            imag = power_imag + const_imag;
+        }
+    };
+
+    struct BurningShipFormula
+    {
+        static constexpr int degree = 2;
+        static constexpr bool julia = false;
+        static constexpr bool mirrorsRows = false;
+
+        template <typename Real>
+        static void step(Real& real, Real& imag, Real const_real, Real const_imag)
+        {
+            const Real abs_real = real < Real(0) ? -real : real;
+            const Real abs_imag = imag < Real(0) ? -imag : imag;
+            real = (abs_real * abs_real - abs_imag * abs_imag) + const_real;
+            imag = (Real(2) * abs_real * abs_imag) + const_imag;
+        }
+    };
+
+    struct TricornFormula
+    {
+        static constexpr int degree = 2;
+        static constexpr bool julia = false;
+        static constexpr bool mirrorsRows = true;
+
+        template <typename Real>
+        static void step(Real& real, Real& imag, Real const_real, Real const_imag)
+        {
+            const Real temp_real = real;
+            real = (real * real - imag * imag) + const_real;
+            imag = (Real(-2) * temp_real * imag) + const_imag;
+        }
+    };
+
+    // Iterates z from (real, imag) with constant (const_real, const_imag) until |z|^2 > 4 or maxIterations steps
+    // NaN and inf orbits count as escaped
+    // Returns: the 0-based step at which z escaped or maxIterations, |z|^2 at escape goes to mag_sq and the steps run are added to executed
+    template <typename Policy, typename Real>
+    inline int escapeTime(Real real, Real imag, Real const_real, Real const_imag, int maxIterations, Real& mag_sq, uint64_t& executed)
+    {
+        int iterations = 0;
+        while (iterations < maxIterations)
+        {
+            Policy::step(real, imag, const_real, const_imag);
+            ++executed;
+            mag_sq = real * real + imag * imag;
+            if (mag_sq > Real(4))
+            {
+                return iterations;
+            }
+            ++iterations;
+        }
+        return iterations;
+    }
+
+    // Calculates iterations for count pixels of row j at columns i, i + step, ... with the formula, the counterpart of getIterationsRow
+    // Smooth counts are written if smooth is not nullptr. The float Mandelbrot formula gives exactly the counts of getIterations
+    // Returns: the z steps the row took
+    uint64_t formulaRow(const FormulaOptions& formula, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step = 1);
+
+    // Returns: true if the formula is the float z^2 + c loop the hand-vectorized kernels calculate
+    inline bool classicFormula(const FormulaOptions& formula) { return formula.type == Formula::MANDELBROT && !formula.doublePrecision; }
+
+    // Returns: true if a row and its mirror image about the real axis (see mirrorRows) have the same counts
+    bool formulaMirrorsRows(const FormulaOptions& formula);
+
+    // Human readable formula name, also accepted by parseFormula
+    const char* formulaName(Formula formula);
+
+    // Returns: true if name is one of the formula names, the formula goes to formula
+    bool parseFormula(const char* name, Formula& formula);
+
+}  // namespace omp
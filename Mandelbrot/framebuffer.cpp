@@ -0,0 +1,104 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Row-major, cache-aligned iteration buffer owned by a view
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "framebuffer.h"
+
+namespace omp {
+
+// rows are padded to a whole number of cache lines for both channels
+constexpr int rowAlignment = int(AlignedArray<uint16_t>::alignment / sizeof(uint16_t));
+
+FrameBuffer::FrameBuffer(int width, int height, bool smooth) : width_(0), height_(0), stride_(0)
+{
+	this->resize(width, height);
+	this->enableSmooth(smooth);
+}
+
+/**
+ * Reallocates the buffer for a new window size. Called when the view receives a resize event.
+ *
+ * @param width of frame in pixels
+ * @param height of frame in pixels
+ * 
+ */
+void FrameBuffer::resize(int width, int height)
+{
+	width = std::max(width, 0);
+	height = std::max(height, 0);
+	if (width == width_ && height == height_)
+	{
+		return;
+	}
+
+	const bool smooth = this->hasSmooth();
+	width_ = width;
+	height_ = height;
+	stride_ = (width + rowAlignment - 1) / rowAlignment * rowAlignment;
+	iterations_.reset(std::size_t(stride_) * height_);
+	smooth_.reset(smooth ? std::size_t(stride_) * height_ : 0);
+	this->clear();
+}
+
+void FrameBuffer::enableSmooth(bool smooth)
+{
+	if (smooth == this->hasSmooth())
+	{
+		return;
+	}
+
+	smooth_.reset(smooth ? std::size_t(stride_) * height_ : 0);
+	std::fill(smooth_.data(), smooth_.data() + smooth_.size(), 0.0f);
+}
+
+/**
+ * Moves the buffer contents for a pan by whole pixels. Rows are visited in the direction
+ * that never overwrites a row before it was copied, memmove handles the overlap within a row.
+ *
+ * @param dx columns the view moved, positive when the view moved right
+ * @param dy rows the view moved, positive when the view moved down
+ * 
+ */
+void FrameBuffer::shift(int dx, int dy)
+{
+	if ((dx == 0 && dy == 0) || std::abs(dx) >= width_ || std::abs(dy) >= height_)
+	{
+		return;
+	}
+
+	const int columns = width_ - std::abs(dx);
+	const int dst_x = std::max(-dx, 0);
+	const int src_x = std::max(dx, 0);
+	const int direction = (dy > 0) ? 1 : -1;
+
+	for (int y = (dy > 0) ? 0 : height_ - 1; y >= 0 && y < height_; y += direction)
+	{
+		const int src_y = y + dy;
+		if (src_y < 0 || src_y >= height_)
+		{
+			break;
+		}
+
+		std::memmove(this->row(y) + dst_x, this->row(src_y) + src_x, columns * sizeof(uint16_t));
+		if (this->hasSmooth())
+		{
+			std::memmove(this->smoothRow(y) + dst_x, this->smoothRow(src_y) + src_x, columns * sizeof(float));
+		}
+	}
+}
+
+void FrameBuffer::clear()
+{
+	std::fill(iterations_.data(), iterations_.data() + iterations_.size(), uint16_t(0));
+	std::fill(smooth_.data(), smooth_.data() + smooth_.size(), 0.0f);
+}
+
+}  // namespace omp
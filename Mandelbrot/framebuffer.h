@@ -0,0 +1,116 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Row-major, cache-aligned iteration buffer owned by a view
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace omp {
+
+    // Heap array aligned to a cache line, elements are left uninitialized
+    template <typename T>
+    class AlignedArray
+    {
+        public:
+            static constexpr std::size_t alignment = 64;
+
+            AlignedArray() : data_(nullptr), size_(0) {}
+            explicit AlignedArray(std::size_t size) : data_(nullptr), size_(0) { this->reset(size); }
+            ~AlignedArray() { this->release(); }
+            AlignedArray(const AlignedArray&) = delete;
+            AlignedArray& operator=(const AlignedArray&) = delete;
+            AlignedArray(AlignedArray&& other) noexcept : data_(other.data_), size_(other.size_) { other.data_ = nullptr; other.size_ = 0; }
+            AlignedArray& operator=(AlignedArray&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    this->release();
+                    data_ = other.data_;
+                    size_ = other.size_;
+                    other.data_ = nullptr;
+                    other.size_ = 0;
+                }
+                return *this;
+            }
+
+            // Reallocates storage for size elements, previous contents are lost
+            void reset(std::size_t size)
+            {
+                this->release();
+                if (size > 0)
+                {
+                    data_ = static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(alignment)));
+                    size_ = size;
+                }
+            }
+
+            T* data() { return data_; }
+            const T* data() const { return data_; }
+            std::size_t size() const { return size_; }
+            T& operator[](std::size_t i) { return data_[i]; }
+            const T& operator[](std::size_t i) const { return data_[i]; }
+
+        private:
+            T* data_;
+            std::size_t size_;
+
+            void release()
+            {
+                if (data_ != nullptr)
+                {
+                    ::operator delete(data_, std::align_val_t(alignment));
+                    data_ = nullptr;
+                    size_ = 0;
+                }
+            }
+    };
+
+    // Iteration counts of a frame stored row by row, every row starts on a 64-byte boundary
+    // An optional float channel holds fractional (smooth) iteration counts for coloring
+    class FrameBuffer
+    {
+        public:
+            FrameBuffer(int width = 0, int height = 0, bool smooth = false);
+
+            // Resizes the buffer to width x height pixels, contents are cleared if the size changes
+            void resize(int width, int height);
+
+            // Allocates or frees the smooth iteration channel
+            void enableSmooth(bool smooth);
+
+            // Translates the contents in place so that the new pixel (x, y) holds the old pixel (x + dx, y + dy)
+            // Pixels that had no source keep stale values and must be recalculated by the caller
+            void shift(int dx, int dy);
+
+            int width() const { return width_; }
+            int height() const { return height_; }
+            int stride() const { return stride_; }  // elements between the start of two rows
+            bool hasSmooth() const { return smooth_.size() != 0; }
+
+            uint16_t* row(int y) { return iterations_.data() + std::size_t(y) * stride_; }
+            const uint16_t* row(int y) const { return iterations_.data() + std::size_t(y) * stride_; }
+            uint16_t& at(int x, int y) { return this->row(y)[x]; }
+            uint16_t at(int x, int y) const { return this->row(y)[x]; }
+
+            // Returns nullptr if the smooth channel is disabled
+            float* smoothRow(int y) { return this->hasSmooth() ? smooth_.data() + std::size_t(y) * stride_ : nullptr; }
+            const float* smoothRow(int y) const { return this->hasSmooth() ? smooth_.data() + std::size_t(y) * stride_ : nullptr; }
+
+        private:
+            int width_;
+            int height_;
+            int stride_;
+            AlignedArray<uint16_t> iterations_;
+            AlignedArray<float> smooth_;
+
+            void clear();
+    };
+
+}  // namespace omp
@@ -0,0 +1,336 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Dependency-free PPM and PNG output for headless rendering, whole or streamed a band at a time
+*/
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "image_writer.h"
+
+namespace omp {
+
+namespace {
+
+constexpr std::size_t maxStoredBlock = 65535;  // deflate stored blocks hold at most this many bytes
+
+const std::array<uint32_t, 256>& crcTable()
+{
+	static const std::array<uint32_t, 256> table = []
+	{
+		std::array<uint32_t, 256> result{};
+		for (uint32_t n = 0; n < 256; ++n)
+		{
+			uint32_t c = n;
+			for (int k = 0; k < 8; ++k)
+			{
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			result[n] = c;
+		}
+		return result;
+	}();
+	return table;
+}
+
+uint32_t crc(const uint8_t* data, std::size_t size, uint32_t value = 0xFFFFFFFFu)
+{
+	for (std::size_t k = 0; k < size; ++k)
+	{
+		value = crcTable()[(value ^ data[k]) & 0xFF] ^ (value >> 8);
+	}
+	return value;
+}
+
+void putBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back(uint8_t(value >> 24));
+	out.push_back(uint8_t(value >> 16));
+	out.push_back(uint8_t(value >> 8));
+	out.push_back(uint8_t(value));
+}
+
+void writeChunk(std::ostream& file, const char* type, const std::vector<uint8_t>& data)
+{
+	std::vector<uint8_t> chunk;
+	putBigEndian(chunk, uint32_t(data.size()));
+	chunk.insert(chunk.end(), type, type + 4);
+	chunk.insert(chunk.end(), data.begin(), data.end());
+	putBigEndian(chunk, crc(chunk.data() + 4, chunk.size() - 4) ^ 0xFFFFFFFFu);
+	file.write(reinterpret_cast<const char*>(chunk.data()), std::streamsize(chunk.size()));
+}
+
+// Filtered PNG scanlines of rows of pixels, every scanline starts with filter type 0 (none)
+void scanlines(std::vector<uint8_t>& raw, const uint32_t* pixels, int width, int rows)
+{
+	raw.clear();
+	raw.reserve(std::size_t(rows) * (std::size_t(width) * 3 + 1));
+	for (int y = 0; y < rows; ++y)
+	{
+		raw.push_back(0);
+		const uint32_t* row = pixels + std::size_t(y) * width;
+		for (int x = 0; x < width; ++x)
+		{
+			raw.push_back(uint8_t(row[x]));
+			raw.push_back(uint8_t(row[x] >> 8));
+			raw.push_back(uint8_t(row[x] >> 16));
+		}
+	}
+}
+
+// Appends raw as stored deflate blocks and updates the adler-32 of the uncompressed data
+void storeBlocks(std::vector<uint8_t>& zlib, const std::vector<uint8_t>& raw, bool final, uint32_t& adler)
+{
+	uint32_t a = adler & 0xFFFF;
+	uint32_t b = adler >> 16;
+	std::size_t offset = 0;
+	do
+	{
+		const std::size_t size = std::min(maxStoredBlock, raw.size() - offset);
+		const bool last = final && offset + size >= raw.size();
+		zlib.push_back(last ? 1 : 0);
+		zlib.push_back(uint8_t(size));
+		zlib.push_back(uint8_t(size >> 8));
+		zlib.push_back(uint8_t(~size));
+		zlib.push_back(uint8_t(~size >> 8));
+		zlib.insert(zlib.end(), raw.begin() + std::ptrdiff_t(offset), raw.begin() + std::ptrdiff_t(offset + size));
+		for (std::size_t k = offset; k < offset + size; ++k)
+		{
+			a = (a + raw[k]) % 65521;
+			b = (b + a) % 65521;
+		}
+		offset += size;
+	} while (offset < raw.size());
+	adler = (b << 16) | a;
+}
+
+void writePngHeader(std::ostream& file, int width, int height)
+{
+	static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	std::vector<uint8_t> header;
+	putBigEndian(header, uint32_t(width));
+	putBigEndian(header, uint32_t(height));
+	header.insert(header.end(), {8, 2, 0, 0, 0});  // 8-bit RGB, deflate, adaptive filtering, no interlace
+	writeChunk(file, "IHDR", header);
+}
+
+/**
+ * PNG with one IDAT chunk. The zlib stream uses stored deflate blocks, which are plain
+ * copies of the filtered scanlines, so no compression library is needed.
+ */
+bool writePng(std::ofstream& file, const uint32_t* pixels, int width, int height)
+{
+	writePngHeader(file, width, height);
+
+	std::vector<uint8_t> raw;
+	scanlines(raw, pixels, width, height);
+	std::vector<uint8_t> zlib = {0x78, 0x01};
+	uint32_t adler = 1;
+	storeBlocks(zlib, raw, true, adler);
+	putBigEndian(zlib, adler);
+	writeChunk(file, "IDAT", zlib);
+	writeChunk(file, "IEND", {});
+	return bool(file);
+}
+
+void writePpmHeader(std::ostream& file, int width, int height)
+{
+	file << "P6\n" << width << " " << height << "\n255\n";
+}
+
+// Packs rows of pixels into PPM RGB bytes
+void ppmRows(std::vector<uint8_t>& out, const uint32_t* pixels, int width, int rows)
+{
+	out.resize(std::size_t(rows) * width * 3);
+	for (std::size_t k = 0; k < std::size_t(rows) * width; ++k)
+	{
+		out[3 * k] = uint8_t(pixels[k]);
+		out[3 * k + 1] = uint8_t(pixels[k] >> 8);
+		out[3 * k + 2] = uint8_t(pixels[k] >> 16);
+	}
+}
+
+bool writePpm(std::ofstream& file, const uint32_t* pixels, int width, int height)
+{
+	writePpmHeader(file, width, height);
+	std::vector<uint8_t> row;
+	for (int y = 0; y < height; ++y)
+	{
+		ppmRows(row, pixels + std::size_t(y) * width, width, 1);
+		file.write(reinterpret_cast<const char*>(row.data()), std::streamsize(row.size()));
+	}
+	return bool(file);
+}
+
+}  // namespace
+
+ImageFormat formatForPath(const std::string& path)
+{
+	std::string extension = path.substr(std::min(path.size(), path.find_last_of('.')));
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+	return (extension == ".png") ? ImageFormat::PNG : ImageFormat::PPM;
+}
+
+bool writeImage(const std::string& path, const uint32_t* pixels, int width, int height)
+{
+	return writeImage(path, pixels, width, height, formatForPath(path));
+}
+
+bool writeImage(const std::string& path, const uint32_t* pixels, int width, int height, ImageFormat format)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+	return (format == ImageFormat::PNG) ? writePng(file, pixels, width, height) : writePpm(file, pixels, width, height);
+}
+
+ImageStream::~ImageStream()
+{
+	file.close();
+}
+
+/**
+ * Creates the image file and writes its header, rows follow through writeRows.
+ *
+ * @param path of the image file, replaced if it exists
+ * @param width of the image in pixels
+ * @param height of the image in pixels
+ * @param format PPM or PNG
+ *
+ */
+bool ImageStream::open(const std::string& path, int width, int height, ImageFormat format)
+{
+	file.close();
+	file.clear();
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+	this->width = width;
+	this->height = height;
+	this->format = format;
+
+	if (format == ImageFormat::PNG)
+	{
+		writePngHeader(file, width, height);
+		writeChunk(file, "IDAT", {0x78, 0x01});  // zlib header, the stored blocks follow in one IDAT per band
+	}
+	else
+	{
+		writePpmHeader(file, width, height);
+	}
+	file.flush();
+	current = State();
+	current.bytes = uint64_t(file.tellp());
+	return bool(file);
+}
+
+/**
+ * Reopens an image written up to a row boundary by an interrupted run. Anything written after
+ * the saved state (a partly written band) is cut off.
+ *
+ * @param path of the partial image file
+ * @param width of the image in pixels
+ * @param height of the image in pixels
+ * @param format PPM or PNG, must match the partial file
+ * @param state returned by state() after the last band that was completely written
+ *
+ */
+bool ImageStream::resume(const std::string& path, int width, int height, ImageFormat format, const State& state)
+{
+	file.close();
+	file.clear();
+	std::error_code error;
+	const std::uintmax_t size = std::filesystem::file_size(path, error);
+	if (error || size < state.bytes || state.rows < 0 || state.rows > height)
+	{
+		return false;
+	}
+	std::filesystem::resize_file(path, state.bytes, error);
+	if (error)
+	{
+		return false;
+	}
+
+	file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+	file.seekp(0, std::ios::end);
+	this->width = width;
+	this->height = height;
+	this->format = format;
+	current = state;
+	return bool(file);
+}
+
+/**
+ * Appends rows to the image and flushes them, so state() always describes a file that can
+ * be resumed.
+ *
+ * @param pixels rows*width packed RGBA pixels, red in the low byte
+ * @param rows number of rows, the total may not exceed the image height
+ *
+ */
+bool ImageStream::writeRows(const uint32_t* pixels, int rows)
+{
+	if (!file.is_open() || rows <= 0 || current.rows + rows > height)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> raw;
+	if (format == ImageFormat::PNG)
+	{
+		std::vector<uint8_t> zlib;
+		scanlines(raw, pixels, width, rows);
+		storeBlocks(zlib, raw, false, current.adler);
+		writeChunk(file, "IDAT", zlib);
+	}
+	else
+	{
+		ppmRows(raw, pixels, width, rows);
+		file.write(reinterpret_cast<const char*>(raw.data()), std::streamsize(raw.size()));
+	}
+	file.flush();
+	if (!file)
+	{
+		return false;
+	}
+	current.rows += rows;
+	current.bytes = uint64_t(file.tellp());
+	return true;
+}
+
+/**
+ * Completes the image once every row is written: PNG gets an empty final deflate block,
+ * the adler-32 checksum and IEND.
+ *
+ */
+bool ImageStream::finish()
+{
+	if (!file.is_open() || current.rows != height)
+	{
+		return false;
+	}
+	if (format == ImageFormat::PNG)
+	{
+		std::vector<uint8_t> zlib = {1, 0, 0, 0xFF, 0xFF};
+		putBigEndian(zlib, current.adler);
+		writeChunk(file, "IDAT", zlib);
+		writeChunk(file, "IEND", {});
+	}
+	file.close();
+	return !file.fail();
+}
+
+}  // namespace omp
@@ -0,0 +1,70 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Dependency-free PPM and PNG output for headless rendering, whole or streamed a band at a time
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace omp {
+
+    enum class ImageFormat
+    {
+        PPM,  // binary P6
+        PNG   // 8-bit RGB, deflate stored blocks (no compression library needed)
+    };
+
+    // Picks the format from the file extension, PNG for ".png" and PPM otherwise
+    ImageFormat formatForPath(const std::string& path);
+
+    // Writes width*height packed RGBA pixels (red in the low byte, row 0 at the top) as RGB, returns false on I/O errors
+    bool writeImage(const std::string& path, const uint32_t* pixels, int width, int height);
+    bool writeImage(const std::string& path, const uint32_t* pixels, int width, int height, ImageFormat format);
+
+    // Writes an image a band of rows at a time, so images larger than memory never have to be held whole
+    // Every band is flushed before writeRows returns, an interrupted file can be resumed from the last state()
+    class ImageStream
+    {
+        public:
+            // Progress of the file, enough to resume it
+            struct State
+            {
+                int rows = 0;         // rows written
+                uint64_t bytes = 0;   // file size after those rows
+                uint32_t adler = 1;   // adler-32 of the PNG scanlines so far
+            };
+
+            ImageStream() = default;
+            ~ImageStream();
+            ImageStream(const ImageStream&) = delete;
+            ImageStream& operator=(const ImageStream&) = delete;
+
+            // Creates the file and writes the header
+            bool open(const std::string& path, int width, int height, ImageFormat format);
+
+            // Reopens a partly written file, bytes after state.bytes are discarded
+            bool resume(const std::string& path, int width, int height, ImageFormat format, const State& state);
+
+            // Appends rows*width packed RGBA pixels below the rows already written
+            bool writeRows(const uint32_t* pixels, int rows);
+
+            // Writes the trailer and closes the file, every row must have been written
+            bool finish();
+
+            const State& state() const { return current; }
+
+        private:
+            std::ofstream file;
+            int width = 0;
+            int height = 0;
+            ImageFormat format = ImageFormat::PPM;
+            State current;
+    };
+
+}  // namespace omp
@@ -35,6 +35,15 @@ double frame_x = -0.5;
 double frame_y = 0;
 double scale = 3;
 
+// Interior short-circuits, off so the output matches the plain escape loop, build with -DCARDIOID_CHECK=1 etc. to opt in
+#ifndef CARDIOID_CHECK
+#define CARDIOID_CHECK 0            // skip points inside the main cardioid and period-2 bulb
+#endif
+#ifndef PERIODICITY_CHECK
+#define PERIODICITY_CHECK 0         // stop once the orbit returns to a saved point
+#endif
+#define PERIODICITY_TOLERANCE 1e-12
+
 int lastx = 0;
 int lasty = 0;
 
@@ -65,6 +74,19 @@ __device__ uint32_t mandelbrot_set(double cr, double ci, int max_iter) {
 
     uint32_t i;
 
+#if CARDIOID_CHECK
+    double xq = cr - 0.25;
+    double q = xq * xq + ci * ci;
+    if (q * (q + xq) <= 0.25 * ci * ci || (cr + 1.0) * (cr + 1.0) + ci * ci <= 0.0625) return max_iter;
+#endif
+
+#if PERIODICITY_CHECK
+    // Brent's scheme: z is saved at iterations 1, 2, 4, 8, ... and a bounded orbit eventually revisits it
+    double real_check = 0;
+    double imag_check = 0;
+    uint32_t checkpoint = 1;
+#endif
+
     for (i = 0; i < max_iter; i++){
 		imag = real * imag;
 		imag += imag;
@@ -74,6 +96,16 @@ __device__ uint32_t mandelbrot_set(double cr, double ci, int max_iter) {
 		imagsqr = imag * imag;
 		
 		if (realsqr + imagsqr > 4.0) break;
+
+#if PERIODICITY_CHECK
+		if (fabs(real - real_check) < PERIODICITY_TOLERANCE && fabs(imag - imag_check) < PERIODICITY_TOLERANCE) return max_iter;
+		if (i == checkpoint)
+		{
+			real_check = real;
+			imag_check = imag;
+			checkpoint *= 2;
+		}
+#endif
     }
 	
     return i;
@@ -6,43 +6,34 @@ Last Date Modified: 12/07/21
 Description: Mandelbrot implementation via OpenMP
 */
 
-#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "mandelbrot_omp.h"
-
-#define MAX_WINDOW_X 1920
-#define MAX_WINDOW_Y 1080
-#define MAX_ITERATIONS 500
+#include "mariani_silver.h"
+#include "symmetry.h"
+#include "trace.h"
 
 namespace omp {
 
 constexpr double eps = 2, umin = -2.2, umax = 0.7, vmin = -1.2, vmax = 1.2;
-int colors[MAX_WINDOW_X*MAX_WINDOW_Y];
 
 /**
  * Display function called in the main.cpp
  *
- * @param width of screen
- * @param height of screen
+ * @param frame iteration buffer of the view, sized to the screen
  * @param zoom scaling factor of fractal 
  * @param frame_x controls where to render fractal in x -changed via panning
  * @param frame_y controls where to render fractal in y-changed via panning
+ * @param pixels width*height packed RGBA pixels, uploaded to the screen by the caller
+ * @param options selects the kernel used to calculate the iterations and the colors
  * 
  */
-void display(int width, int height, float zoom, float frame_x, float frame_y)
+void display(FrameBuffer& frame, float zoom, float frame_x, float frame_y, uint32_t* pixels, const RenderOptions& options)
 {
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	gluOrtho2D(0, width, 0, height);
-	glMatrixMode(GL_MODELVIEW);	
-	glLoadIdentity();
-
-	glClearColor(0.0, 0.0, 0.0, 1.0);
-	glClear(GL_COLOR_BUFFER_BIT| GL_DEPTH_BUFFER_BIT);
-	glPointSize(1.0);
-
-	mandelbrotSet(width, height, zoom, frame_x, frame_y);
-	glFlush();
+	mandelbrotSet(frame, zoom, frame_x, frame_y, options);
+	colorize(frame, pixels, MAX_ITERATIONS, options.color);
 }
 
 
@@ -50,29 +41,277 @@ void display(int width, int height, float zoom, float frame_x, float frame_y)
  * Display function called by display which calls getIterations to see if number
  * is within the mandelbrot set.
  *
- * @param width of screen
- * @param height of screen
+ * @param frame iteration buffer of the view, tiles are filled in parallel by the worker pool
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param options selects the kernel and algorithm used to calculate the iterations
+ * 
+ */
+void mandelbrotSet(FrameBuffer& frame, float zoom, float frame_x, float frame_y, const RenderOptions& options)
+{
+	// filling uniform rectangles relies on the Mandelbrot set being connected and containing the origin
+	if (options.algorithm == Algorithm::MARIANI_SILVER && classicFormula(options.formula))
+	{
+		marianiSilver(frame, zoom, frame_x, frame_y, options);
+		return;
+	}
+	if (options.symmetry && formulaMirrorsRows(options.formula))
+	{
+		const std::vector<int> mirror = mirrorRows(frame.height(), std::min(frame.width(), frame.height()), zoom, frame_y);
+		if (mirroredRowCount(mirror) > 0)
+		{
+			renderMirrored(frame, mirror, zoom, frame_x, frame_y, options);
+			return;
+		}
+	}
+	renderRegion(frame, 0, 0, frame.width(), frame.height(), zoom, frame_x, frame_y, options);
+}
+
+/**
+ * Calculates the rows of the frame that do not mirror another row, then copies the mirrored
+ * rows from their sources. The counts match a full render bit for bit.
+ *
+ * @param frame iteration buffer of the view
+ * @param mirror source row of every mirrored row, -1 for calculated rows (see mirrorRows)
  * @param zoom scaling factor of fractal 
  * @param frame_x controls where to render fractal in x -changed via panning
  * @param frame_y controls where to render fractal in y-changed via panning
+ * @param options selects the kernel, tile size and interior checks
+ * @param cancel optional flag, remaining tiles are skipped once it is set
  * 
  */
-void mandelbrotSet(int width, int height, float zoom, float frame_x, float frame_y)
+bool renderMirrored(FrameBuffer& frame, const std::vector<int>& mirror, float zoom, float frame_x, float frame_y, const RenderOptions& options, const std::atomic<bool>* cancel)
 {
-	int minDim = (width < height) ? width : height;  // prevents stretching
-	#pragma omp parallel for
-	for (int ix = 0; ix < width; ++ix)
-		for (int iy = 0; iy < height; ++iy)
+	int minDim = (frame.width() < frame.height()) ? frame.width() : frame.height();
+	RenderOptions resolved = options;
+	resolved.kernel = resolveKernel(options.kernel);
+
+	std::vector<Tile> tiles = TileScheduler::makeTiles(frame.width(), frame.height(), options.tileSize);
+	for (Tile& tile : tiles)
+	{
+		const int calculated = int(std::count(mirror.begin() + tile.y, mirror.begin() + tile.y + tile.height, -1));
+		tile.cost = estimateTileCost(tile, minDim, minDim, zoom, frame_x, frame_y) * calculated / tile.height;
+	}
+	const bool completed = TileScheduler::instance().run(std::move(tiles), [&](const Tile& tile)
+	{
+		TRACE_SCOPE("tile");
+		uint64_t executed = 0;
+		for (int iy = tile.y; iy < tile.y + tile.height; ++iy)
 		{
-			colors[ix * width + iy] = getIterations(ix, iy, minDim, minDim, zoom, frame_x, frame_y);
+			if (mirror[iy] < 0)
+			{
+				float* smooth = frame.smoothRow(iy);
+				executed += calculateRow(resolved, frame.row(iy) + tile.x, smooth ? smooth + tile.x : nullptr, tile.x, iy, tile.width, minDim, minDim, zoom, frame_x, frame_y, 1);
+			}
 		}
-	for (int i = 0; i < width; ++i)
-    {
-        for (int j = 0; j < height; ++j)
+		TRACE_COUNT("tiles", 1);
+		TRACE_COUNT("iterations", int64_t(executed));
+	}, cancel);
+	if (completed)
+	{
+		copyMirroredRows(frame, mirror);
+	}
+	return completed;
+}
+
+/**
+ * Calculates a rectangle of the frame on the worker pool. Used for full frames and for the
+ * strips exposed when the view is panned.
+ *
+ * @param frame iteration buffer of the view
+ * @param x left column of the rectangle
+ * @param y top row of the rectangle
+ * @param width of the rectangle in pixels
+ * @param height of the rectangle in pixels
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param options selects the kernel, tile size and interior checks
+ * @param cancel optional flag, remaining tiles are skipped once it is set
+ * 
+ */
+bool renderRegion(FrameBuffer& frame, int x, int y, int width, int height, float zoom, float frame_x, float frame_y, const RenderOptions& options, const std::atomic<bool>* cancel)
+{
+	int minDim = (frame.width() < frame.height()) ? frame.width() : frame.height();  // prevents stretching
+	RenderOptions resolved = options;
+	resolved.kernel = resolveKernel(options.kernel);
+
+	std::vector<Tile> tiles = TileScheduler::makeTiles(width, height, options.tileSize);
+	for (Tile& tile : tiles)
+	{
+		tile.x += x;
+		tile.y += y;
+		tile.cost = estimateTileCost(tile, minDim, minDim, zoom, frame_x, frame_y);
+	}
+	return TileScheduler::instance().run(std::move(tiles), [&](const Tile& tile)
+	{
+		renderTile(frame, tile, zoom, frame_x, frame_y, resolved);
+	}, cancel);
+}
+
+/**
+ * Calculates a horizontal band of an image that is too large to keep in memory. Pixels are
+ * mapped with the size of the whole image, so stacking the bands gives the full frame.
+ *
+ * @param frame iteration buffer receiving the band, as wide as the image
+ * @param top first image row of the band
+ * @param height of the whole image in pixels
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param options selects the kernel, tile size and interior checks
+ * @param cancel optional flag, remaining tiles are skipped once it is set
+ * 
+ */
+bool renderBand(FrameBuffer& frame, int top, int height, float zoom, float frame_x, float frame_y, const RenderOptions& options, const std::atomic<bool>* cancel)
+{
+	int minDim = (frame.width() < height) ? frame.width() : height;
+	RenderOptions resolved = options;
+	resolved.kernel = resolveKernel(options.kernel);
+
+	std::vector<Tile> tiles = TileScheduler::makeTiles(frame.width(), frame.height(), options.tileSize);
+	for (Tile& tile : tiles)
+	{
+		Tile image = tile;
+		image.y += top;
+		tile.cost = estimateTileCost(image, minDim, minDim, zoom, frame_x, frame_y);
+	}
+	return TileScheduler::instance().run(std::move(tiles), [&](const Tile& tile)
+	{
+		TRACE_SCOPE("tile");
+		uint64_t executed = 0;
+		for (int iy = tile.y; iy < tile.y + tile.height; ++iy)
 		{
-			drawPoint(i, j, height, colors[i* width + j]);
-		} 
-    } 
+			float* smooth = frame.smoothRow(iy);
+			executed += calculateRow(resolved, frame.row(iy) + tile.x, smooth ? smooth + tile.x : nullptr, tile.x, top + iy, tile.width, minDim, minDim, zoom, frame_x, frame_y, 1);
+		}
+		TRACE_COUNT("tiles", 1);
+		TRACE_COUNT("iterations", int64_t(executed));
+	}, cancel);
+}
+
+/**
+ * Calculates the iterations of every pixel in a tile, one row segment at a time.
+ *
+ * @param frame iteration buffer of the view
+ * @param tile pixels to calculate
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param options kernel and interior checks used for each row segment
+ * 
+ */
+void renderTile(FrameBuffer& frame, const Tile& tile, float zoom, float frame_x, float frame_y, const RenderOptions& options)
+{
+	TRACE_SCOPE("tile");
+	int minDim = (frame.width() < frame.height()) ? frame.width() : frame.height();
+	uint64_t executed = 0;
+	for (int iy = tile.y; iy < tile.y + tile.height; ++iy)
+	{
+		float* smooth = frame.smoothRow(iy);
+		executed += calculateRow(options, frame.row(iy) + tile.x, smooth ? smooth + tile.x : nullptr, tile.x, iy, tile.width, minDim, minDim, zoom, frame_x, frame_y, 1);
+	}
+	TRACE_COUNT("tiles", 1);
+	TRACE_COUNT("iterations", int64_t(executed));
+}
+
+/**
+ * Calculates a row segment, the hand-vectorized kernels cover the float Mandelbrot formula
+ * and every other formula goes through the formula engine.
+ *
+ * @param options kernel and interior checks, or the formula for the formula engine
+ * @param iterations receives count counts
+ * @param smooth optional, receives count smooth counts
+ * @param i first column
+ * @param j row
+ * @param count number of samples
+ * @param width of fractal in pixels
+ * @param height of fractal in pixels
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param step column spacing of the samples
+ * 
+ */
+uint64_t calculateRow(const RenderOptions& options, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step)
+{
+	if (classicFormula(options.formula))
+	{
+		return getIterationsRow(options.kernel, iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step, options.interior);
+	}
+	return formulaRow(options.formula, iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step);
+}
+
+/**
+ * Shifts the point of the view center from pixel (minDim/2, minDim/2), where the mapping of
+ * pixelToReal/pixelToImag puts it, to the middle of the frame.
+ *
+ * @param real real part of the point wanted in the middle of the frame
+ * @param imag imaginary part of the point wanted in the middle of the frame
+ * @param width of the frame in pixels
+ * @param height of the frame in pixels
+ * @param zoom scaling factor of fractal, the shorter side spans 5 * zoom
+ * @param frame_x receives the x coordinate of the frame
+ * @param frame_y receives the y coordinate of the frame
+ *
+ */
+void centerFrame(double real, double imag, int width, int height, float zoom, float& frame_x, float& frame_y)
+{
+	FormulaOptions single;
+	centerFrame(real, imag, width, height, zoom, frame_x, frame_y, single);
+}
+
+/**
+ * Centers the frame like the overload above. The frame position is rounded to float for the
+ * kernels, a double precision formula gets the rounding error back through the formula
+ * options, so its view center keeps double precision.
+ *
+ * @param real real part of the point wanted in the middle of the frame
+ * @param imag imaginary part of the point wanted in the middle of the frame
+ * @param width of the frame in pixels
+ * @param height of the frame in pixels
+ * @param zoom scaling factor of fractal, the shorter side spans 5 * zoom
+ * @param frame_x receives the x coordinate of the frame
+ * @param frame_y receives the y coordinate of the frame
+ * @param formula receives frame_x_lo/frame_y_lo, zero unless it is in double precision
+ *
+ */
+void centerFrame(double real, double imag, int width, int height, float zoom, float& frame_x, float& frame_y, FormulaOptions& formula)
+{
+	const double minDim = std::max(1, std::min(width, height));
+	const double x = real / 5.0 - (width / (2.0 * minDim) - 0.5) * zoom;
+	const double y = (height / (2.0 * minDim) - 0.5) * zoom - imag / 5.0;
+	frame_x = float(x);
+	frame_y = float(y);
+	formula.frame_x_lo = formula.doublePrecision ? x - frame_x : 0.0;
+	formula.frame_y_lo = formula.doublePrecision ? y - frame_y : 0.0;
+}
+
+/**
+ * Samples the corners and center of a tile. Tiles touching the interior of the set
+ * run every pixel to MAX_ITERATIONS, so they are handed out first.
+ *
+ * @param tile pixels to estimate
+ * @param width of fractal in pixels
+ * @param height of fractal in pixels
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * 
+ */
+uint64_t estimateTileCost(const Tile& tile, int width, int height, float zoom, float frame_x, float frame_y)
+{
+	const int right = tile.x + tile.width - 1;
+	const int bottom = tile.y + tile.height - 1;
+	const int samples[5][2] = {{tile.x, tile.y}, {right, tile.y}, {tile.x, bottom}, {right, bottom}, {(tile.x + right) / 2, (tile.y + bottom) / 2}};
+
+	uint64_t cost = 0;
+	for (const auto& sample : samples)
+	{
+		cost += getIterations(sample[0], sample[1], width, height, zoom, frame_x, frame_y) + 1;
+	}
+	return cost * uint64_t(tile.width) * tile.height;
 }
 
 /**
@@ -86,16 +325,33 @@ void mandelbrotSet(int width, int height, float zoom, float frame_x, float frame
  * @param zoom scaling factor of fractal 
  * @param frame_x controls where to render fractal in x -changed via panning
  * @param frame_y controls where to render fractal in y-changed via panning
+ * @param escape_mag_sq optional output, |z|^2 at the iteration the pixel escaped
+ * @param checks optional interior short-circuits, points they catch return MAX_ITERATIONS
+ * @param executed optional output, number of z^2 + c steps taken (0 for points the cardioid/bulb test catches)
  * 
  */
-int getIterations(int i, int j, int width, int height, float zoom, float frame_x, float frame_y) 
+int getIterations(int i, int j, int width, int height, float zoom, float frame_x, float frame_y, float* escape_mag_sq, InteriorChecks checks, int* executed) 
 {
-	float real = ((i / float(width) - 0.5f) * zoom + frame_x) * 5.0;
-    float imag = ((j / float(height) - 0.5f) * zoom - frame_y) * 5.0;
+	float real = pixelToReal(i, width, zoom, frame_x);
+    float imag = pixelToImag(j, height, zoom, frame_y);
  
     int iterations = 0;
     float const_real = real;
     float const_imag = imag;
+
+	if (executed != nullptr)
+	{
+		*executed = 0;
+	}
+	if (checks.cardioid && inCardioidOrBulb(const_real, const_imag))
+	{
+		return MAX_ITERATIONS;
+	}
+
+	// Brent's scheme: z is saved at iterations 1, 2, 4, 8, ... and a bounded orbit eventually revisits it
+	float check_real = 0.0f;
+	float check_imag = 0.0f;
+	int checkpoint = 1;
  
     while (iterations < MAX_ITERATIONS)
 	{
@@ -107,43 +363,62 @@ int getIterations(int i, int j, int width, int height, float zoom, float frame_x
          
         if (mag_sq > 4.0)
 		{
+			if (escape_mag_sq != nullptr)
+			{
+				*escape_mag_sq = mag_sq;
+			}
+			if (executed != nullptr)
+			{
+				*executed = iterations + 1;
+			}
 			return iterations;
 		}
 
+		if (checks.periodicity)
+		{
+			if (std::fabs(real - check_real) < periodicityTolerance && std::fabs(imag - check_imag) < periodicityTolerance)
+			{
+				if (executed != nullptr)
+				{
+					*executed = iterations + 1;
+				}
+				return MAX_ITERATIONS;
+			}
+			if (iterations == checkpoint)
+			{
+				check_real = real;
+				check_imag = imag;
+				checkpoint *= 2;
+			}
+		}
+
         ++iterations;
     }
 
+	if (executed != nullptr)
+	{
+		*executed = iterations;
+	}
     return iterations;
 }
 
-/**
- * Draw the point on the screen.
- * 
- */
-void drawPoint(int i, int j, int height, int color)
-{
-	glBegin(GL_POINTS);
-	setColor(color);
-	glVertex2i(i, height - j);
-	glEnd();
-}
-
 /**
  * Assigns a color based returned iteration.
  *
- * @param color represents the iteration returned.
+ * @param iterations represents the iteration returned.
+ * @param maxIterations iteration limit, counts at the limit are inside the set
  * 
  */
-void setColor(int color)
+uint32_t getColor(int iterations, int maxIterations)
 {
-	if (color == MAX_ITERATIONS)
+	constexpr uint32_t alpha = 0xFFu << 24;
+	if (iterations >= maxIterations)
 	{
-		glColor3f(0, 0, 0);
-	}
-	else
-	{
-		glColor3f((double)color / MAX_ITERATIONS, (double)color / MAX_ITERATIONS, 0);
+		return alpha;  // black
 	}
+
+	uint32_t intensity = (uint32_t(iterations) * 255 + maxIterations / 2) / maxIterations;
+	return alpha | (intensity << 8) | intensity;  // yellow scaled on [0,1]
 }
 
 }  // namespace omp
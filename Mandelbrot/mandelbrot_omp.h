@@ -8,21 +8,99 @@ Description: Mandelbrot implementation via OpenMP
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "coloring.h"
+#include "formula.h"
+#include "framebuffer.h"
+#include "mandelbrot_simd.h"
+#include "tile_scheduler.h"
+
 namespace omp {
 
-    // Calculates mandelbrot set via multi-threading and calls necessary OpenGL functions
-    void display(int width, int height, float zoom, float frame_x, float frame_y);
+    constexpr int MAX_ITERATIONS = 500;
+
+    enum class Algorithm
+    {
+        BRUTE_FORCE,    // every pixel is iterated
+        MARIANI_SILVER  // only rectangle borders are iterated, rectangles with a uniform escaping border or inside the cardioid/bulb are filled
+    };
+
+    // Tunables for the CPU renderer, defaults match the original implementation
+    struct RenderOptions
+    {
+        Kernel kernel = Kernel::AUTO;  // escape-time kernel used for each row
+        int tileSize = 32;             // edge length of the square tiles handed to the worker threads
+        Algorithm algorithm = Algorithm::BRUTE_FORCE;
+        InteriorChecks interior;       // cardioid/bulb test and periodicity detection, off by default
+        bool tileCache = false;        // assemble views that snap to the tile pyramid from cached tiles
+        bool symmetry = true;          // copy rows that mirror other rows about the real axis instead of calculating them, same counts
+        ColorOptions color;            // palette and mapping of the coloring pass, changing it alone only recolors
+        FormulaOptions formula;        // other formulas than float z^2 + c run on the formula engine, which ignores kernel and interior
+    };
+
+    struct DeepView;
+
+    // Snapshot of what the user is looking at
+    struct View
+    {
+        int width = 0;   // window size in pixels, an empty view renders nothing
+        int height = 0;
+        float zoom = 1.f;
+        float frame_x = 0.f;
+        float frame_y = 0.f;
+        RenderOptions options;
+        std::shared_ptr<const DeepView> deep;  // set for the deep zoom mode, which ignores zoom/frame_x/frame_y
+    };
+
+    // Calculates mandelbrot set into the view's frame buffer and colors it into width*height packed RGBA pixels
+    void display(FrameBuffer& frame, float zoom, float frame_x, float frame_y, uint32_t* pixels, const RenderOptions& options = RenderOptions());
+
+    // Calculates mandelbrot set via multi-threading into the frame buffer
+    void mandelbrotSet(FrameBuffer& frame, float zoom, float frame_x, float frame_y, const RenderOptions& options = RenderOptions());
+
+    // Calculates a width x height rectangle of the frame at (x, y), returns false if cancelled
+    bool renderRegion(FrameBuffer& frame, int x, int y, int width, int height, float zoom, float frame_x, float frame_y, const RenderOptions& options = RenderOptions(), const std::atomic<bool>* cancel = nullptr);
+
+    // Calculates rows top to top + frame.height() of a frame.width() x height image, so images larger than memory can be rendered a band at a time
+    // Counts match mandelbrotSet on the whole image, returns false if cancelled
+    bool renderBand(FrameBuffer& frame, int top, int height, float zoom, float frame_x, float frame_y, const RenderOptions& options = RenderOptions(), const std::atomic<bool>* cancel = nullptr);
+
+    // Calculates the rows mirror (see mirrorRows) marks with -1 and copies the others from their mirror image, returns false if cancelled
+    bool renderMirrored(FrameBuffer& frame, const std::vector<int>& mirror, float zoom, float frame_x, float frame_y, const RenderOptions& options = RenderOptions(), const std::atomic<bool>* cancel = nullptr);
+
+    // Calculates a row segment like getIterationsRow, with the selected kernel for the float Mandelbrot formula and with formulaRow otherwise
+    // Returns: the z steps the kernel executed for the segment
+    uint64_t calculateRow(const RenderOptions& options, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step = 1);
+
+    // Calculates the iterations of one tile of the frame with the selected kernel
+    void renderTile(FrameBuffer& frame, const Tile& tile, float zoom, float frame_x, float frame_y, const RenderOptions& options);
+
+    // Estimates the cost of a tile from a few samples so expensive tiles can be scheduled first
+    uint64_t estimateTileCost(const Tile& tile, int width, int height, float zoom, float frame_x, float frame_y);
+
+    // Calculates number of iterations for a specific pixel, optionally reports |z|^2 at escape and the z steps it took
+    int getIterations(int i, int j, int width, int height, float zoom, float frame_x, float frame_y, float* escape_mag_sq = nullptr, InteriorChecks checks = InteriorChecks(), int* executed = nullptr);
+
+    // Maps a pixel column/row to the real/imaginary part of c, shared by every kernel so results match bit for bit
+    inline float pixelToReal(int i, int width, float zoom, float frame_x) { return ((i / float(width) - 0.5f) * zoom + frame_x) * 5.0; }
+    inline float pixelToImag(int j, int height, float zoom, float frame_y) { return ((j / float(height) - 0.5f) * zoom - frame_y) * 5.0; }
 
-    // Calculates mandelbrot set via multi-threading
-    void mandelbrotSet(int width, int height, float zoom, float frame_x, float frame_y);
+    // The mapping puts real = 5 * frame_x, imag = -5 * frame_y at pixel (minDim/2, minDim/2), which is the middle of square frames only
+    // Finds the frame_x/frame_y that put real + imag*i in the middle of a width x height frame instead
+    void centerFrame(double real, double imag, int width, int height, float zoom, float& frame_x, float& frame_y);
 
-    // Calculates number of iterations for a specific pixel
-    int getIterations(int i, int j, int width, int height, float zoom, float frame_x, float frame_y);
+    // Same, for a double precision formula the part of the frame position float drops goes to formula.frame_x_lo/frame_y_lo
+    void centerFrame(double real, double imag, int width, int height, float zoom, float& frame_x, float& frame_y, FormulaOptions& formula);
 
-    // Draws a single pixel in matrix
-    void drawPoint(int i, int j, int height, int color);
+    // Colors the calculated iterations into width*height packed RGBA pixels, row 0 is the top of the frame
+    // Runs as its own parallel pass over the frame, so a finished frame can be recolored without iterating
+    void colorize(const FrameBuffer& frame, uint32_t* pixels, int maxIterations = MAX_ITERATIONS, const ColorOptions& color = ColorOptions());
 
-    // Sets color of a single pixel in matrix
-    void setColor(int color);
+    // Maps an iteration count to a packed RGBA color (red in the low byte)
+    uint32_t getColor(int iterations, int maxIterations = MAX_ITERATIONS);
 
 }  // namespace omp
@@ -0,0 +1,395 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Vectorized escape-time kernels for the OpenMP Mandelbrot renderer
+             The instruction set is picked at runtime so one binary runs on every host
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OMP_SIMD_X86 1
+#endif
+
+#include "mandelbrot_omp.h"
+#include "mandelbrot_simd.h"
+
+namespace omp {
+
+namespace {
+
+/**
+ * Scalar fallback, iterates one pixel at a time.
+ */
+uint64_t rowScalar(uint16_t* iterations, float* mag_sq, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step, bool column, InteriorChecks checks)
+{
+	uint64_t executed = 0;
+	for (int k = 0; k < count; ++k)
+	{
+		int steps = 0;
+		const int x = column ? i : i + k * step;
+		const int y = column ? j + k * step : j;
+		iterations[k] = uint16_t(getIterations(x, y, width, height, zoom, frame_x, frame_y, mag_sq ? mag_sq + k : nullptr, checks, &steps));
+		executed += uint64_t(steps);
+	}
+	return executed;
+}
+
+#ifdef OMP_SIMD_X86
+
+/**
+ * Iterates 8 pixels of a row at once. Lanes retire from the active mask as they escape
+ * and keep the iteration count they escaped at, exactly like the scalar loop.
+ * The interior checks follow the scalar loop as well, all lanes share the checkpoint schedule.
+ * The operations are issued in the same order as getIterations (no FMA) so counts match bit for bit.
+ * A column gives every lane its own imaginary part instead of its own real part.
+ * Returns the steps of the lanes that were still active, padding lanes of a partial vector excluded.
+ */
+__attribute__((target("avx2")))
+uint64_t rowAVX2(uint16_t* iterations, float* mag_sq_out, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step, bool column, InteriorChecks checks)
+{
+	const __m256 two = _mm256_set1_ps(2.0f);
+	const __m256 four = _mm256_set1_ps(4.0f);
+	const __m256i max_count = _mm256_set1_epi32(MAX_ITERATIONS);
+	const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+	const __m256 tolerance = _mm256_set1_ps(periodicityTolerance);
+	const float real_scalar = pixelToReal(i, width, zoom, frame_x);
+	const float imag_scalar = pixelToImag(j, height, zoom, frame_y);
+	uint64_t executed = 0;
+
+	for (int k = 0; k < count; k += 8)
+	{
+		const int lanes = std::min(8, count - k);
+		const int valid = (1 << lanes) - 1;
+		alignas(32) float real_lanes[8];
+		alignas(32) float imag_lanes[8];
+		alignas(32) int iteration_lanes[8];
+		alignas(32) int active_lanes[8];
+		alignas(32) float mag_sq_lanes[8];
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			// pad a partial vector with the last pixel, the extra lanes are discarded
+			const int sample = k + std::min(lane, lanes - 1);
+			real_lanes[lane] = column ? real_scalar : pixelToReal(i + sample * step, width, zoom, frame_x);
+			imag_lanes[lane] = column ? pixelToImag(j + sample * step, height, zoom, frame_y) : imag_scalar;
+			const bool interior = checks.cardioid && inCardioidOrBulb(real_lanes[lane], imag_lanes[lane]);
+			active_lanes[lane] = interior ? 0 : -1;
+			iteration_lanes[lane] = interior ? MAX_ITERATIONS : 0;
+		}
+
+		const __m256 const_real = _mm256_load_ps(real_lanes);
+		const __m256 const_imag = _mm256_load_ps(imag_lanes);
+		__m256 real = const_real;
+		__m256 imag = const_imag;
+		__m256 active = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(active_lanes)));
+		__m256i count_lanes = _mm256_load_si256(reinterpret_cast<const __m256i*>(iteration_lanes));
+		__m256 escape_mag_sq = _mm256_setzero_ps();
+		__m256 check_real = _mm256_setzero_ps();
+		__m256 check_imag = _mm256_setzero_ps();
+		int checkpoint = 1;
+
+		for (int n = 0; n < MAX_ITERATIONS; ++n)
+		{
+			const int running = _mm256_movemask_ps(active);
+			if (running == 0)
+			{
+				break;
+			}
+			executed += uint64_t(__builtin_popcount(running & valid));
+
+			const __m256 temp_real = real;
+			real = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(real, real), _mm256_mul_ps(imag, imag)), const_real);
+			imag = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(two, temp_real), imag), const_imag);
+
+			const __m256 mag_sq = _mm256_add_ps(_mm256_mul_ps(real, real), _mm256_mul_ps(imag, imag));
+			const __m256 escaped = _mm256_and_ps(_mm256_cmp_ps(mag_sq, four, _CMP_GT_OQ), active);
+			escape_mag_sq = _mm256_blendv_ps(escape_mag_sq, mag_sq, escaped);
+			active = _mm256_andnot_ps(escaped, active);
+
+			if (checks.periodicity)
+			{
+				// lanes back at their checkpoint are bounded, they retire with the maximum count
+				const __m256 near_real = _mm256_cmp_ps(_mm256_andnot_ps(sign_mask, _mm256_sub_ps(real, check_real)), tolerance, _CMP_LT_OQ);
+				const __m256 near_imag = _mm256_cmp_ps(_mm256_andnot_ps(sign_mask, _mm256_sub_ps(imag, check_imag)), tolerance, _CMP_LT_OQ);
+				const __m256 periodic = _mm256_and_ps(_mm256_and_ps(near_real, near_imag), active);
+				count_lanes = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(count_lanes), _mm256_castsi256_ps(max_count), periodic));
+				active = _mm256_andnot_ps(periodic, active);
+				if (n == checkpoint)
+				{
+					check_real = real;
+					check_imag = imag;
+					checkpoint *= 2;
+				}
+			}
+
+			// active lanes are all ones (-1), subtracting increments them
+			count_lanes = _mm256_sub_epi32(count_lanes, _mm256_castps_si256(active));
+		}
+
+		_mm256_store_si256(reinterpret_cast<__m256i*>(iteration_lanes), count_lanes);
+		std::transform(iteration_lanes, iteration_lanes + lanes, iterations + k, [](int n) { return uint16_t(n); });
+		if (mag_sq_out != nullptr)
+		{
+			_mm256_store_ps(mag_sq_lanes, escape_mag_sq);
+			std::copy(mag_sq_lanes, mag_sq_lanes + lanes, mag_sq_out + k);
+		}
+	}
+	return executed;
+}
+
+/**
+ * Iterates 16 pixels of a row at once using AVX-512 mask registers for the active lanes.
+ */
+__attribute__((target("avx512f")))
+uint64_t rowAVX512(uint16_t* iterations, float* mag_sq_out, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step, bool column, InteriorChecks checks)
+{
+	const __m512 two = _mm512_set1_ps(2.0f);
+	const __m512 four = _mm512_set1_ps(4.0f);
+	const __m512i one = _mm512_set1_epi32(1);
+	const __m512i max_count = _mm512_set1_epi32(MAX_ITERATIONS);
+	const __m512 tolerance = _mm512_set1_ps(periodicityTolerance);
+	const float real_scalar = pixelToReal(i, width, zoom, frame_x);
+	const float imag_scalar = pixelToImag(j, height, zoom, frame_y);
+	uint64_t executed = 0;
+
+	for (int k = 0; k < count; k += 16)
+	{
+		const int lanes = std::min(16, count - k);
+		const int valid = (1 << lanes) - 1;
+		alignas(64) float real_lanes[16];
+		alignas(64) float imag_lanes[16];
+		alignas(64) int iteration_lanes[16];
+		alignas(64) float mag_sq_lanes[16];
+		__mmask16 active = 0;
+		for (int lane = 0; lane < 16; ++lane)
+		{
+			const int sample = k + std::min(lane, lanes - 1);
+			real_lanes[lane] = column ? real_scalar : pixelToReal(i + sample * step, width, zoom, frame_x);
+			imag_lanes[lane] = column ? pixelToImag(j + sample * step, height, zoom, frame_y) : imag_scalar;
+			const bool interior = checks.cardioid && inCardioidOrBulb(real_lanes[lane], imag_lanes[lane]);
+			active |= interior ? 0 : (1 << lane);
+			iteration_lanes[lane] = interior ? MAX_ITERATIONS : 0;
+		}
+
+		const __m512 const_real = _mm512_load_ps(real_lanes);
+		const __m512 const_imag = _mm512_load_ps(imag_lanes);
+		__m512 real = const_real;
+		__m512 imag = const_imag;
+		__m512i count_lanes = _mm512_load_si512(iteration_lanes);
+		__m512 escape_mag_sq = _mm512_setzero_ps();
+		__m512 check_real = _mm512_setzero_ps();
+		__m512 check_imag = _mm512_setzero_ps();
+		int checkpoint = 1;
+
+		for (int n = 0; n < MAX_ITERATIONS && active != 0; ++n)
+		{
+			executed += uint64_t(__builtin_popcount(active & valid));
+
+			const __m512 temp_real = real;
+			real = _mm512_add_ps(_mm512_sub_ps(_mm512_mul_ps(real, real), _mm512_mul_ps(imag, imag)), const_real);
+			imag = _mm512_add_ps(_mm512_mul_ps(_mm512_mul_ps(two, temp_real), imag), const_imag);
+
+			const __m512 mag_sq = _mm512_add_ps(_mm512_mul_ps(real, real), _mm512_mul_ps(imag, imag));
+			const __mmask16 escaped = _mm512_mask_cmp_ps_mask(active, mag_sq, four, _CMP_GT_OQ);
+			escape_mag_sq = _mm512_mask_mov_ps(escape_mag_sq, escaped, mag_sq);
+			active &= static_cast<__mmask16>(~escaped);
+
+			if (checks.periodicity)
+			{
+				const __mmask16 near_real = _mm512_mask_cmp_ps_mask(active, _mm512_abs_ps(_mm512_sub_ps(real, check_real)), tolerance, _CMP_LT_OQ);
+				const __mmask16 periodic = _mm512_mask_cmp_ps_mask(near_real, _mm512_abs_ps(_mm512_sub_ps(imag, check_imag)), tolerance, _CMP_LT_OQ);
+				count_lanes = _mm512_mask_mov_epi32(count_lanes, periodic, max_count);
+				active &= static_cast<__mmask16>(~periodic);
+				if (n == checkpoint)
+				{
+					check_real = real;
+					check_imag = imag;
+					checkpoint *= 2;
+				}
+			}
+
+			count_lanes = _mm512_mask_add_epi32(count_lanes, active, count_lanes, one);
+		}
+
+		_mm512_store_si512(iteration_lanes, count_lanes);
+		std::transform(iteration_lanes, iteration_lanes + lanes, iterations + k, [](int n) { return uint16_t(n); });
+		if (mag_sq_out != nullptr)
+		{
+			_mm512_store_ps(mag_sq_lanes, escape_mag_sq);
+			std::copy(mag_sq_lanes, mag_sq_lanes + lanes, mag_sq_out + k);
+		}
+	}
+	return executed;
+}
+
+#endif  // OMP_SIMD_X86
+
+}  // namespace
+
+bool kernelSupported(Kernel kernel)
+{
+	switch (kernel)
+	{
+		case Kernel::AUTO:
+		case Kernel::SCALAR:
+			return true;
+#ifdef OMP_SIMD_X86
+		case Kernel::AVX2:
+			return __builtin_cpu_supports("avx2");
+		case Kernel::AVX512:
+			return __builtin_cpu_supports("avx512f");
+#endif
+		default:
+			return false;
+	}
+}
+
+Kernel resolveKernel(Kernel kernel)
+{
+	if (kernel != Kernel::AUTO && kernelSupported(kernel))
+	{
+		return kernel;
+	}
+
+	if (kernel != Kernel::AVX2 && kernelSupported(Kernel::AVX512))
+	{
+		return Kernel::AVX512;
+	}
+	if (kernelSupported(Kernel::AVX2))
+	{
+		return Kernel::AVX2;
+	}
+	return Kernel::SCALAR;
+}
+
+const char* kernelName(Kernel kernel)
+{
+	switch (kernel)
+	{
+		case Kernel::AUTO:
+			return "auto";
+		case Kernel::SCALAR:
+			return "scalar";
+		case Kernel::AVX2:
+			return "avx2";
+		case Kernel::AVX512:
+			return "avx512";
+	}
+	return "unknown";
+}
+
+namespace {
+
+/**
+ * Dispatches a row or column segment to the requested kernel.
+ *
+ * @param kernel kernel to run, resolved to a supported kernel if necessary
+ * @param iterations output for count pixels
+ * @param smooth optional output for count fractional iteration counts, may be nullptr
+ * @param i first column, or the column of a column segment
+ * @param j row, or the first row of a column segment
+ * @param count number of pixels
+ * @param step spacing between the pixels of consecutive outputs
+ * @param column true to walk down column i instead of along row j
+ * @param checks optional interior short-circuits
+ * 
+ */
+uint64_t iterateSegment(Kernel kernel, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step, bool column, InteriorChecks checks)
+{
+	// the smooth channel first receives |z|^2 at escape and is converted in place below
+	uint64_t executed = 0;
+	switch (resolveKernel(kernel))
+	{
+#ifdef OMP_SIMD_X86
+		case Kernel::AVX2:
+			executed = rowAVX2(iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step, column, checks);
+			break;
+		case Kernel::AVX512:
+			executed = rowAVX512(iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step, column, checks);
+			break;
+#endif
+		default:
+			executed = rowScalar(iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step, column, checks);
+			break;
+	}
+
+	if (smooth != nullptr)
+	{
+		for (int k = 0; k < count; ++k)
+		{
+			smooth[k] = smoothIterations(iterations[k], smooth[k], MAX_ITERATIONS);
+		}
+	}
+	return executed;
+}
+
+}  // namespace
+
+/**
+ * Dispatches a row to the requested kernel.
+ *
+ * @param kernel kernel to run, resolved to a supported kernel if necessary
+ * @param iterations output for count pixels
+ * @param smooth optional output for count fractional iteration counts, may be nullptr
+ * @param i first column of the row
+ * @param j row
+ * @param count number of pixels
+ * @param width of fractal in pixels
+ * @param height of fractal in pixels
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param step spacing between the columns of consecutive outputs
+ * @param checks optional interior short-circuits
+ * 
+ */
+uint64_t getIterationsRow(Kernel kernel, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step, InteriorChecks checks)
+{
+	return iterateSegment(kernel, iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step, false, checks);
+}
+
+/**
+ * Dispatches a column to the requested kernel, the lanes of a vector are consecutive rows.
+ *
+ * @param kernel kernel to run, resolved to a supported kernel if necessary
+ * @param iterations output for count pixels, top to bottom
+ * @param smooth optional output for count fractional iteration counts, may be nullptr
+ * @param i column
+ * @param j first row of the column
+ * @param count number of pixels
+ * @param width of fractal in pixels
+ * @param height of fractal in pixels
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param step spacing between the rows of consecutive outputs
+ * @param checks optional interior short-circuits
+ * 
+ */
+uint64_t getIterationsColumn(Kernel kernel, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step, InteriorChecks checks)
+{
+	return iterateSegment(kernel, iterations, smooth, i, j, count, width, height, zoom, frame_x, frame_y, step, true, checks);
+}
+
+/**
+ * Fractional iteration count used for smooth coloring (normalized iteration count).
+ *
+ * @param iterations integer iteration count of the pixel
+ * @param mag_sq squared magnitude of z when the pixel escaped
+ * @param maxIterations iteration limit the count was calculated with
+ * 
+ */
+float smoothIterations(int iterations, float mag_sq, int maxIterations)
+{
+	if (iterations >= maxIterations)
+	{
+		return float(maxIterations);
+	}
+	return iterations + 1.0f - std::log2(0.5f * std::log2(mag_sq));
+}
+
+}  // namespace omp
@@ -0,0 +1,64 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Vectorized escape-time kernels for the OpenMP Mandelbrot renderer
+             The instruction set is picked at runtime so one binary runs on every host
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace omp {
+
+    enum class Kernel
+    {
+        AUTO,    // best kernel supported by this CPU
+        SCALAR,  // one pixel at a time via getIterations
+        AVX2,    // 8 pixels at a time
+        AVX512   // 16 pixels at a time
+    };
+
+    // Optional early exits for points inside the set, both are off by default so every kernel matches the original loop
+    struct InteriorChecks
+    {
+        bool cardioid = false;     // analytic main cardioid and period-2 bulb test before iterating
+        bool periodicity = false;  // Brent-style detection of orbits that revisit a checkpoint while iterating
+    };
+
+    // Per component distance at which an orbit is considered to have returned to its checkpoint
+    constexpr float periodicityTolerance = 1e-6f;
+
+    // Returns true if c lies inside the main cardioid or the period-2 bulb
+    inline bool inCardioidOrBulb(float real, float imag)
+    {
+        const float x = real - 0.25f;
+        const float imag_sq = imag * imag;
+        const float q = x * x + imag_sq;
+        const float bulb = real + 1.0f;
+        return (q * (q + x) <= 0.25f * imag_sq) || (bulb * bulb + imag_sq <= 0.0625f);
+    }
+
+    // Returns the kernel that will actually run, falls back to the best supported kernel
+    Kernel resolveKernel(Kernel kernel);
+
+    // Returns true if the CPU (and OS) support the kernel
+    bool kernelSupported(Kernel kernel);
+
+    // Human readable kernel name
+    const char* kernelName(Kernel kernel);
+
+    // Calculates iterations for count pixels of row j at columns i, i + step, i + 2*step, ... into consecutive outputs
+    // Every kernel produces exactly the same counts as getIterations, smooth counts are written if smooth is not nullptr
+    // Returns: the z^2 + c steps the pixels ran, points the interior checks answered only count the steps they took
+    uint64_t getIterationsRow(Kernel kernel, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step = 1, InteriorChecks checks = InteriorChecks());
+
+    // Same as getIterationsRow for count pixels of column i at rows j, j + step, j + 2*step, ...
+    uint64_t getIterationsColumn(Kernel kernel, uint16_t* iterations, float* smooth, int i, int j, int count, int width, int height, float zoom, float frame_x, float frame_y, int step = 1, InteriorChecks checks = InteriorChecks());
+
+    // Fractional iteration count of a pixel that escaped with |z|^2 = mag_sq
+    float smoothIterations(int iterations, float mag_sq, int maxIterations);
+
+}  // namespace omp
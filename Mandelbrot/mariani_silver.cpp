@@ -0,0 +1,287 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Mariani-Silver rectangle subdivision for the OpenMP Mandelbrot renderer
+             Only rectangle borders are calculated, rectangles with a uniform escaping border or inside the
+             main cardioid / period-2 bulb are filled
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include "mariani_silver.h"
+
+namespace omp {
+
+namespace {
+
+// Shared state of one subdivision pass
+struct Subdivision
+{
+	FrameBuffer& frame;
+	float zoom;
+	float frame_x;
+	float frame_y;
+	Kernel kernel;
+	InteriorChecks checks;
+	int minDim;
+	std::atomic<uint64_t> evaluated;
+};
+
+// Calculates count pixels of row y starting at column x
+void calculateRow(Subdivision& pass, int x, int y, int count)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+	float* smooth = pass.frame.smoothRow(y);
+	getIterationsRow(pass.kernel, pass.frame.row(y) + x, smooth ? smooth + x : nullptr, x, y, count, pass.minDim, pass.minDim, pass.zoom, pass.frame_x, pass.frame_y, 1, pass.checks);
+	pass.evaluated.fetch_add(uint64_t(count), std::memory_order_relaxed);
+}
+
+// Calculates count pixels of column x starting at row y, one kernel call gathered into scratch buffers
+void calculateColumn(Subdivision& pass, int x, int y, int count)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+	thread_local std::vector<uint16_t> iterations;
+	thread_local std::vector<float> smooth;
+	iterations.resize(size_t(count));
+	smooth.resize(pass.frame.hasSmooth() ? size_t(count) : 0);
+	getIterationsColumn(pass.kernel, iterations.data(), smooth.empty() ? nullptr : smooth.data(), x, y, count, pass.minDim, pass.minDim, pass.zoom, pass.frame_x, pass.frame_y, 1, pass.checks);
+	pass.evaluated.fetch_add(uint64_t(count), std::memory_order_relaxed);
+
+	for (int k = 0; k < count; ++k)
+	{
+		pass.frame.row(y + k)[x] = iterations[size_t(k)];
+		if (!smooth.empty())
+		{
+			pass.frame.smoothRow(y + k)[x] = smooth[size_t(k)];
+		}
+	}
+}
+
+// Exact main cardioid test in double, q * (q + x - 1/4) <= y^2 / 4 with q = (x - 1/4)^2 + y^2
+bool inCardioid(double real, double imag)
+{
+	const double x = real - 0.25;
+	const double q = x * x + imag * imag;
+	return q * (q + x) <= 0.25 * imag * imag;
+}
+
+// Exact period-2 bulb test in double, the disk of radius 1/4 around -1
+bool inBulb(double real, double imag)
+{
+	const double x = real + 1.0;
+	return x * x + imag * imag <= 0.0625;
+}
+
+// Samples of the four corner pixels of a rectangle, in double for the exact interior tests
+struct Corners
+{
+	double left;
+	double right;
+	double top;
+	double bottom;
+
+	template <typename Inside>
+	int count(Inside inside) const
+	{
+		return int(inside(left, top)) + int(inside(right, top)) + int(inside(left, bottom)) + int(inside(right, bottom));
+	}
+};
+
+Corners corners(const Subdivision& pass, const Tile& rect)
+{
+	return {pixelToReal(rect.x, pass.minDim, pass.zoom, pass.frame_x),
+	        pixelToReal(rect.x + rect.width - 1, pass.minDim, pass.zoom, pass.frame_x),
+	        pixelToImag(rect.y, pass.minDim, pass.zoom, pass.frame_y),
+	        pixelToImag(rect.y + rect.height - 1, pass.minDim, pass.zoom, pass.frame_y)};
+}
+
+/**
+ * Checks whether every pixel of the rectangle lies in the main cardioid or the period-2 bulb,
+ * where the plain loop runs to MAX_ITERATIONS. The bulb is a disk, and the cardioid is convex
+ * once cut by the real axis or by x = 1/4 left of its cusp, so the corners being inside one
+ * such convex piece puts every sample between them inside it: pixelToReal and pixelToImag
+ * are monotone, so the samples of inner pixels lie between the corner samples.
+ */
+bool insideSet(const Subdivision& pass, const Tile& rect)
+{
+	const Corners c = corners(pass, rect);
+	if (c.count(inBulb) == 4)
+	{
+		return true;
+	}
+	const bool convexPiece = c.top >= 0.0 || c.bottom <= 0.0 || c.right <= 0.25;
+	return convexPiece && c.count(inCardioid) == 4;
+}
+
+// Checks whether any corner of the rectangle lies in the main cardioid or the period-2 bulb
+bool touchesSet(const Subdivision& pass, const Tile& rect)
+{
+	const Corners c = corners(pass, rect);
+	return c.count(inCardioid) + c.count(inBulb) > 0;
+}
+
+/**
+ * Checks whether every border pixel of the rectangle (inclusive corners) has the same count.
+ * A uniform border below MAX_ITERATIONS only proves the interior if the rectangle does not
+ * enclose the whole set, which happens exactly when it contains the origin. A border at
+ * MAX_ITERATIONS proves nothing about the pixels: filaments thinner than a pixel pass
+ * between the samples, so subdivide only fills those rectangles if insideSet proves them.
+ */
+bool uniformBorder(const Subdivision& pass, const Tile& rect, uint16_t& value)
+{
+	const FrameBuffer& frame = pass.frame;
+	const int x1 = rect.x + rect.width - 1;
+	const int y1 = rect.y + rect.height - 1;
+	value = frame.at(rect.x, rect.y);
+
+	for (int x = rect.x; x <= x1; ++x)
+	{
+		if (frame.at(x, rect.y) != value || frame.at(x, y1) != value)
+		{
+			return false;
+		}
+	}
+	for (int y = rect.y + 1; y < y1; ++y)
+	{
+		if (frame.at(rect.x, y) != value || frame.at(x1, y) != value)
+		{
+			return false;
+		}
+	}
+
+	if (value == MAX_ITERATIONS)
+	{
+		return true;
+	}
+	if (frame.hasSmooth())
+	{
+		return false;  // escaping pixels need their own fractional count
+	}
+
+	const float left = pixelToReal(rect.x, pass.minDim, pass.zoom, pass.frame_x);
+	const float right = pixelToReal(x1, pass.minDim, pass.zoom, pass.frame_x);
+	const float top = pixelToImag(rect.y, pass.minDim, pass.zoom, pass.frame_y);
+	const float bottom = pixelToImag(y1, pass.minDim, pass.zoom, pass.frame_y);
+	return !(left <= 0.0f && right >= 0.0f && top <= 0.0f && bottom >= 0.0f);
+}
+
+/**
+ * Processes one rectangle whose border is already calculated. Rectangles with a uniform
+ * escaping border are filled. Rectangles bordered by the set are filled if insideSet
+ * proves them to be in the main cardioid or period-2 bulb, otherwise they are subdivided
+ * like any other: small ones are calculated directly and the rest are split in four by a
+ * calculated cross whose quadrants are spawned as new tasks.
+ *
+ * @param pass shared state of the subdivision
+ * @param rect rectangle including its border
+ * 
+ */
+void subdivide(Subdivision& pass, const Tile& rect)
+{
+	const int x0 = rect.x;
+	const int y0 = rect.y;
+	const int x1 = rect.x + rect.width - 1;
+	const int y1 = rect.y + rect.height - 1;
+	if (rect.width <= 2 || rect.height <= 2)
+	{
+		return;  // no interior
+	}
+
+	uint16_t value;
+	const bool uniform = uniformBorder(pass, rect, value);
+	if (uniform && (value != MAX_ITERATIONS || insideSet(pass, rect)))
+	{
+		for (int y = y0 + 1; y < y1; ++y)
+		{
+			std::fill(pass.frame.row(y) + x0 + 1, pass.frame.row(y) + x1, value);
+			if (float* smooth = pass.frame.smoothRow(y))
+			{
+				std::fill(smooth + x0 + 1, smooth + x1, float(value));
+			}
+		}
+		return;
+	}
+
+	// a set border away from the cardioid and bulb (a minibrot) would never be filled, its rows run longer vectors
+	const bool unfillable = uniform && !touchesSet(pass, rect);
+	if (unfillable || rect.width < marianiSilverMinSize || rect.height < marianiSilverMinSize)
+	{
+		for (int y = y0 + 1; y < y1; ++y)
+		{
+			calculateRow(pass, x0 + 1, y, rect.width - 2);
+		}
+		return;
+	}
+
+	const int mx = (x0 + x1) / 2;
+	const int my = (y0 + y1) / 2;
+	calculateRow(pass, x0 + 1, my, rect.width - 2);
+	calculateColumn(pass, mx, y0 + 1, my - y0 - 1);
+	calculateColumn(pass, mx, my + 1, y1 - my - 1);
+
+	const uint64_t cost = uint64_t(rect.width) * rect.height;
+	TileScheduler& scheduler = TileScheduler::instance();
+	scheduler.spawn({x0, y0, mx - x0 + 1, my - y0 + 1, cost / 4});
+	scheduler.spawn({mx, y0, x1 - mx + 1, my - y0 + 1, cost / 4});
+	scheduler.spawn({x0, my, mx - x0 + 1, y1 - my + 1, cost / 4});
+	scheduler.spawn({mx, my, x1 - mx + 1, y1 - my + 1, cost / 4});
+}
+
+}  // namespace
+
+/**
+ * Renders the frame with Mariani-Silver subdivision. The frame border is calculated first,
+ * then the frame is subdivided as described in subdivide.
+ *
+ * @param frame iteration buffer of the view
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param options selects the kernel and interior checks
+ * @param cancel optional flag, queued rectangles are dropped once it is set
+ * @param evaluated optional output, number of pixels that were iterated
+ * 
+ */
+bool marianiSilver(FrameBuffer& frame, float zoom, float frame_x, float frame_y, const RenderOptions& options, const std::atomic<bool>* cancel, uint64_t* evaluated)
+{
+	const int width = frame.width();
+	const int height = frame.height();
+	Subdivision pass{frame, zoom, frame_x, frame_y, resolveKernel(options.kernel), options.interior, std::min(width, height), {0}};
+
+	bool completed = true;
+	if (width > 0 && height > 0)
+	{
+		calculateRow(pass, 0, 0, width);
+		if (height > 1)
+		{
+			calculateRow(pass, 0, height - 1, width);
+		}
+		calculateColumn(pass, 0, 1, height - 2);
+		if (width > 1)
+		{
+			calculateColumn(pass, width - 1, 1, height - 2);
+		}
+
+		completed = TileScheduler::instance().run({{0, 0, width, height, 0}}, [&](const Tile& rect)
+		{
+			subdivide(pass, rect);
+		}, cancel);
+	}
+
+	if (evaluated != nullptr)
+	{
+		*evaluated = pass.evaluated.load();
+	}
+	return completed;
+}
+
+}  // namespace omp
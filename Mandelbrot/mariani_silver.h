@@ -0,0 +1,28 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Mariani-Silver rectangle subdivision for the OpenMP Mandelbrot renderer
+             Only rectangle borders are calculated, rectangles with a uniform escaping border or inside the
+             main cardioid / period-2 bulb are filled
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "mandelbrot_omp.h"
+
+namespace omp {
+
+    // Rectangles smaller than this (in pixels per side) are calculated row by row, their 16 pixel inner rows fill one AVX-512 vector
+    constexpr int marianiSilverMinSize = 18;
+
+    // Calculates the frame by recursive subdivision, the subdivisions run as tasks on the worker pool
+    // evaluated (optional) receives the number of pixels whose iterations were actually calculated
+    // Returns: false if cancelled
+    bool marianiSilver(FrameBuffer& frame, float zoom, float frame_x, float frame_y, const RenderOptions& options = RenderOptions(), const std::atomic<bool>* cancel = nullptr, uint64_t* evaluated = nullptr);
+
+}  // namespace omp
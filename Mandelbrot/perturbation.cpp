@@ -0,0 +1,382 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Deep zoom renderer for the OpenMP Mandelbrot set using perturbation theory
+             One reference orbit is iterated in fixed point, every pixel only iterates its
+             difference to the reference in double precision
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "perturbation.h"
+
+namespace omp {
+
+namespace {
+
+constexpr double glitchTolerance = 1e-6;  // |z|^2 below this fraction of |Z|^2 means the delta lost its precision
+constexpr double seriesTolerance = 1e-6;  // largest truncated series term relative to the linear term
+constexpr int chunkSize = 256;            // pixels per task on the worker pool
+
+// Reference orbit Z_0 .. Z_length rounded to double, Z_length escaped if length < maxIterations
+struct Reference
+{
+	std::vector<double> real;
+	std::vector<double> imag;
+	std::vector<double> glitch;  // glitchTolerance * |Z_n|^2
+	int length = 0;
+};
+
+// Series approximation dz_n = A dc + B dc^2 + C dc^3 of every pixel at iteration skip
+struct Series
+{
+	int skip = 0;
+	double a_real = 0.0, a_imag = 0.0;
+	double b_real = 0.0, b_imag = 0.0;
+	double c_real = 0.0, c_imag = 0.0;
+};
+
+/**
+ * Iterates Z = Z^2 + C in fixed point until it escapes or reaches the iteration limit.
+ *
+ * @param c_real real part of the reference point
+ * @param c_imag imaginary part of the reference point
+ * @param maxIterations iteration limit of the view
+ *
+ */
+Reference referenceOrbit(const FixedPoint& c_real, const FixedPoint& c_imag, int maxIterations)
+{
+	Reference reference;
+	reference.real.reserve(std::size_t(maxIterations) + 1);
+	reference.imag.reserve(std::size_t(maxIterations) + 1);
+	reference.glitch.reserve(std::size_t(maxIterations) + 1);
+	reference.real.push_back(0.0);
+	reference.imag.push_back(0.0);
+	reference.glitch.push_back(0.0);
+
+	const int limbs = c_real.precision();
+	FixedPoint real(limbs);
+	FixedPoint imag(limbs);
+	while (reference.length < maxIterations)
+	{
+		const FixedPoint cross = real * imag;
+		real = real * real - imag * imag + c_real;
+		imag = cross + cross + c_imag;
+		++reference.length;
+
+		const double z_real = real.toDouble();
+		const double z_imag = imag.toDouble();
+		const double mag_sq = z_real * z_real + z_imag * z_imag;
+		reference.real.push_back(z_real);
+		reference.imag.push_back(z_imag);
+		reference.glitch.push_back(glitchTolerance * mag_sq);
+		if (mag_sq > 4.0)
+		{
+			break;
+		}
+	}
+	return reference;
+}
+
+/**
+ * Advances the series coefficients along the reference while the cubic term stays negligible
+ * for the pixel farthest from the reference.
+ * A' = 2ZA + 1, B' = 2ZB + A^2, C' = 2ZC + 2AB
+ *
+ * @param reference orbit the pixels are perturbed from
+ * @param radius largest |dc| of the pixels that use the series
+ *
+ */
+Series approximate(const Reference& reference, double radius)
+{
+	Series series;
+	const double radius_sq = radius * radius;
+	for (int n = 0; n < reference.length - 1; ++n)
+	{
+		const double z_real = 2.0 * reference.real[n];
+		const double z_imag = 2.0 * reference.imag[n];
+		const Series& s = series;
+
+		Series next;
+		next.skip = n + 1;
+		next.a_real = z_real * s.a_real - z_imag * s.a_imag + 1.0;
+		next.a_imag = z_real * s.a_imag + z_imag * s.a_real;
+		next.b_real = z_real * s.b_real - z_imag * s.b_imag + (s.a_real * s.a_real - s.a_imag * s.a_imag);
+		next.b_imag = z_real * s.b_imag + z_imag * s.b_real + 2.0 * s.a_real * s.a_imag;
+		next.c_real = z_real * s.c_real - z_imag * s.c_imag + 2.0 * (s.a_real * s.b_real - s.a_imag * s.b_imag);
+		next.c_imag = z_real * s.c_imag + z_imag * s.c_real + 2.0 * (s.a_real * s.b_imag + s.a_imag * s.b_real);
+
+		const double a = std::hypot(next.a_real, next.a_imag);
+		const double c = std::hypot(next.c_real, next.c_imag);
+		if (!std::isfinite(a) || !std::isfinite(c) || c * radius_sq > seriesTolerance * a)
+		{
+			break;
+		}
+		series = next;
+	}
+	return series;
+}
+
+// Per pass state shared by the workers
+struct Pass
+{
+	FrameBuffer& frame;
+	const Reference& reference;
+	const Series& series;
+	const std::vector<double>& offset_real;  // dc of every column relative to the view center
+	const std::vector<double>& offset_imag;  // dc of every row relative to the view center
+	double reference_real;                   // reference position relative to the view center
+	double reference_imag;
+	int maxIterations;
+};
+
+/**
+ * Iterates the difference dz between a pixel orbit and the reference orbit:
+ * dz' = 2 Z dz + dz^2 + dc. The pixel escapes when |Z + dz|^2 > 4 like the float kernels.
+ * Returns false if the pixel glitched, closeness then holds |z|^2 / |Z|^2 at the glitch.
+ */
+bool perturbPixel(const Pass& pass, double dc_real, double dc_imag, int& count, float& mag_sq_out, float& closeness)
+{
+	const Reference& reference = pass.reference;
+	const Series& series = pass.series;
+
+	int n = series.skip;
+	double dz_real = 0.0;
+	double dz_imag = 0.0;
+	if (n > 0)
+	{
+		const double dc2_real = dc_real * dc_real - dc_imag * dc_imag;
+		const double dc2_imag = 2.0 * dc_real * dc_imag;
+		const double dc3_real = dc2_real * dc_real - dc2_imag * dc_imag;
+		const double dc3_imag = dc2_real * dc_imag + dc2_imag * dc_real;
+		dz_real = series.a_real * dc_real - series.a_imag * dc_imag + series.b_real * dc2_real - series.b_imag * dc2_imag + series.c_real * dc3_real - series.c_imag * dc3_imag;
+		dz_imag = series.a_real * dc_imag + series.a_imag * dc_real + series.b_real * dc2_imag + series.b_imag * dc2_real + series.c_real * dc3_imag + series.c_imag * dc3_real;
+
+		const double z_real = reference.real[n] + dz_real;
+		const double z_imag = reference.imag[n] + dz_imag;
+		if (z_real * z_real + z_imag * z_imag > 4.0)
+		{
+			// escaped during the skipped iterations, iterate this pixel from the start
+			n = 0;
+			dz_real = 0.0;
+			dz_imag = 0.0;
+		}
+	}
+
+	for (; n < pass.maxIterations; ++n)
+	{
+		if (n >= reference.length)
+		{
+			closeness = 1.0f;  // the reference escaped before this pixel
+			count = n;
+			return false;
+		}
+
+		const double z_real = 2.0 * reference.real[n] + dz_real;
+		const double z_imag = 2.0 * reference.imag[n] + dz_imag;
+		const double temp_real = dz_real;
+		dz_real = z_real * dz_real - z_imag * dz_imag + dc_real;
+		dz_imag = z_real * dz_imag + z_imag * temp_real + dc_imag;
+
+		const double real = reference.real[n + 1] + dz_real;
+		const double imag = reference.imag[n + 1] + dz_imag;
+		const double mag_sq = real * real + imag * imag;
+		if (mag_sq > 4.0)
+		{
+			count = n;
+			mag_sq_out = float(mag_sq);
+			return true;
+		}
+		if (mag_sq < reference.glitch[n + 1])
+		{
+			closeness = float(mag_sq / (reference.glitch[n + 1] / glitchTolerance));
+			count = n;
+			return false;
+		}
+	}
+
+	count = pass.maxIterations;
+	return true;
+}
+
+}  // namespace
+
+/**
+ * Like centerFrame: the deep mapping puts the center at pixel (minDim/2, minDim/2), so the
+ * center moves back by the distance from there to the middle of the image.
+ *
+ * @param view deep view, its zoom sets the distance
+ * @param real real part of the point wanted in the middle of the image
+ * @param imag imaginary part of the point wanted in the middle of the image
+ * @param width of the image in pixels
+ * @param height of the image in pixels
+ *
+ */
+void centerDeepView(DeepView& view, const FixedPoint& real, const FixedPoint& imag, int width, int height)
+{
+	const double minDim = std::max(1, std::min(width, height));
+	view.center_real = real;
+	view.center_imag = imag;
+	view.center_real -= FixedPoint(real.precision(), (width / (2.0 * minDim) - 0.5) * view.zoom * 5.0);
+	view.center_imag -= FixedPoint(imag.precision(), (height / (2.0 * minDim) - 0.5) * view.zoom * 5.0);
+}
+
+/**
+ * Escape times near the boundary grow faster than the depth: in seahorse valley the slowest
+ * escaping pixels need about 4.3 * depth^2 iterations (depth in octaves, 18k at zoom 1e-20,
+ * 43k at 1e-30), so the limit grows with the square of the depth until the counts fill uint16_t.
+ *
+ * @param zoom zoom of the deep view
+ *
+ */
+int deepIterationLimit(double zoom)
+{
+	const double depth = std::log2(1.0 / std::min(std::max(zoom, deepZoomLimit), 1.0));
+	return int(std::min(65535.0, MAX_ITERATIONS + 5.0 * depth * depth));
+}
+
+/**
+ * Renders a deep view. The first reference sits at the view center, pixels whose delta lost
+ * its precision (Pauldelbrot's criterion) are collected and rendered again from a new reference
+ * placed at the most glitched of them, until no glitches remain or maxReferences is reached.
+ *
+ * @param frame iteration buffer of the view, already sized to the window
+ * @param view fixed-point center, zoom and iteration limit
+ * @param cancel optional flag, the frame is abandoned once it is set
+ * @param stats optional output, references and skipped iterations
+ *
+ */
+bool renderPerturbation(FrameBuffer& frame, const DeepView& view, const std::atomic<bool>* cancel, PerturbationStats* stats)
+{
+	return renderPerturbationBand(frame, 0, frame.height(), view, cancel, stats);
+}
+
+/**
+ * Renders rows top to top + frame.height() of a deep view that is height rows tall, so images
+ * larger than memory can be rendered a band at a time. Every band picks its own references.
+ *
+ * @param frame iteration buffer receiving the band, as wide as the image
+ * @param top first image row of the band
+ * @param height of the whole image in pixels
+ * @param view fixed-point center, zoom and iteration limit
+ * @param cancel optional flag, the band is abandoned once it is set
+ * @param stats optional output, references and skipped iterations
+ *
+ */
+bool renderPerturbationBand(FrameBuffer& frame, int top, int height, const DeepView& view, const std::atomic<bool>* cancel, PerturbationStats* stats)
+{
+	const int width = frame.width();
+	const int rows = frame.height();
+	const int minDim = std::min(width, height);
+	PerturbationStats result;
+	if (width <= 0 || rows <= 0)
+	{
+		return true;
+	}
+
+	// same mapping as pixelToReal/pixelToImag, width and height both use minDim to prevent stretching
+	std::vector<double> offset_real(width);
+	std::vector<double> offset_imag(rows);
+	for (int i = 0; i < width; ++i)
+	{
+		offset_real[i] = (i / double(minDim) - 0.5) * view.zoom * 5.0;
+	}
+	for (int j = 0; j < rows; ++j)
+	{
+		offset_imag[j] = ((top + j) / double(minDim) - 0.5) * view.zoom * 5.0;
+	}
+
+	std::vector<int> pending(std::size_t(width) * rows);
+	for (std::size_t k = 0; k < pending.size(); ++k)
+	{
+		pending[k] = int(k);
+	}
+	std::vector<float> closeness(pending.size());
+	std::vector<uint8_t> glitched(pending.size());
+
+	const int limbs = std::max({FixedPoint::limbsForZoom(view.zoom), view.center_real.precision(), view.center_imag.precision()});
+	double reference_real = 0.0;
+	double reference_imag = 0.0;
+	for (int attempt = 0; attempt < maxReferences && !pending.empty(); ++attempt)
+	{
+		FixedPoint c_real(limbs, reference_real);
+		FixedPoint c_imag(limbs, reference_imag);
+		c_real += view.center_real;
+		c_imag += view.center_imag;
+		const Reference reference = referenceOrbit(c_real, c_imag, view.maxIterations);
+
+		double radius_sq = 0.0;
+		for (int index : pending)
+		{
+			const double dc_real = offset_real[index % width] - reference_real;
+			const double dc_imag = offset_imag[index / width] - reference_imag;
+			radius_sq = std::max(radius_sq, dc_real * dc_real + dc_imag * dc_imag);
+		}
+		const Series series = approximate(reference, std::sqrt(radius_sq));
+		if (attempt == 0)
+		{
+			result.skipped = series.skip;
+		}
+		++result.references;
+
+		const Pass pass{frame, reference, series, offset_real, offset_imag, reference_real, reference_imag, view.maxIterations};
+		std::vector<Tile> chunks = TileScheduler::makeTiles(int(pending.size()), 1, chunkSize);
+		const bool completed = TileScheduler::instance().run(std::move(chunks), [&](const Tile& chunk)
+		{
+			for (int k = chunk.x; k < chunk.x + chunk.width; ++k)
+			{
+				const int index = pending[k];
+				const int x = index % width;
+				const int y = index / width;
+				int count = 0;
+				float mag_sq = 0.0f;
+				const bool exact = perturbPixel(pass, offset_real[x] - pass.reference_real, offset_imag[y] - pass.reference_imag, count, mag_sq, closeness[index]);
+				glitched[index] = exact ? 0 : 1;
+				frame.at(x, y) = uint16_t(count);
+				float* smooth = frame.smoothRow(y);
+				if (smooth != nullptr)
+				{
+					smooth[x] = smoothIterations(count, mag_sq, view.maxIterations);
+				}
+			}
+		}, cancel);
+		if (!completed)
+		{
+			return false;
+		}
+
+		// the next reference goes where the orbit came closest to the reference, the core of the glitch
+		std::size_t remaining = 0;
+		int worst = -1;
+		for (int index : pending)
+		{
+			if (glitched[index])
+			{
+				pending[remaining++] = index;
+				if (worst < 0 || closeness[index] < closeness[worst])
+				{
+					worst = index;
+				}
+			}
+		}
+		pending.resize(remaining);
+		if (worst >= 0)
+		{
+			reference_real = offset_real[worst % width];
+			reference_imag = offset_imag[worst / width];
+		}
+	}
+
+	result.glitched = pending.size();
+	if (stats != nullptr)
+	{
+		*stats = result;
+	}
+	return true;
+}
+
+}  // namespace omp
@@ -0,0 +1,60 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Deep zoom renderer for the OpenMP Mandelbrot set using perturbation theory
+             One reference orbit is iterated in fixed point, every pixel only iterates its
+             difference to the reference in double precision
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "fixed_point.h"
+#include "mandelbrot_omp.h"
+
+namespace omp {
+
+    // Deepest zoom of the deep view, pixel offsets must stay normal doubles
+    constexpr double deepZoomLimit = 1e-300;
+
+    // References calculated per frame at most, pixels still glitched after the last one keep its count
+    constexpr int maxReferences = 16;
+
+    // View of the deep zoom mode, the fixed-point center replaces frame_x/frame_y of the float view
+    // The mapping matches pixelToReal/pixelToImag: center_real = 5 * frame_x, center_imag = -5 * frame_y
+    struct DeepView
+    {
+        FixedPoint center_real;
+        FixedPoint center_imag;
+        double zoom = 1.0;
+        int maxIterations = MAX_ITERATIONS;  // counts up to 65535 fit the frame buffer
+    };
+
+    // What a deep frame cost, for tuning and the console
+    struct PerturbationStats
+    {
+        int references = 0;     // reference orbits calculated, 1 if nothing glitched
+        int skipped = 0;        // iterations of the first reference skipped by series approximation
+        uint64_t glitched = 0;  // pixels still glitched after the last reference
+    };
+
+    // Sets the center of the view so real + imag*i lands in the middle of a width x height image, the counterpart of centerFrame
+    // view.zoom must be set first, the center keeps the precision of real and imag
+    void centerDeepView(DeepView& view, const FixedPoint& real, const FixedPoint& imag, int width, int height);
+
+    // Iteration limit that keeps detail visible as the view gets deeper
+    int deepIterationLimit(double zoom);
+
+    // Renders the deep view into the frame buffer, counts range up to view.maxIterations
+    // Returns: false if cancelled
+    bool renderPerturbation(FrameBuffer& frame, const DeepView& view, const std::atomic<bool>* cancel = nullptr, PerturbationStats* stats = nullptr);
+
+    // Renders rows top to top + frame.height() of a deep view that is frame.width() x height pixels, matching renderPerturbation on the full frame
+    // Returns: false if cancelled
+    bool renderPerturbationBand(FrameBuffer& frame, int top, int height, const DeepView& view, const std::atomic<bool>* cancel = nullptr, PerturbationStats* stats = nullptr);
+
+}  // namespace omp
@@ -0,0 +1,209 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Out-of-core renderer for print sized images
+             The image is calculated in horizontal bands that are colored and streamed to disk in order,
+             so memory depends on the band height and not on the image size
+*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "image_writer.h"
+#include "poster.h"
+
+namespace omp {
+
+namespace {
+
+constexpr const char* checkpointMagic = "fractal-poster 1";
+
+struct Band
+{
+	int rows;
+	std::vector<uint32_t> pixels;
+};
+
+// Everything that changes the pixels of the file, a checkpoint is only resumed if it matches
+std::string describe(const PosterJob& job, ImageFormat format)
+{
+	std::ostringstream text;
+	text << job.width << "x" << job.height << (format == ImageFormat::PNG ? " png" : " ppm")
+	     << " interior " << job.options.interior.cardioid << job.options.interior.periodicity;
+	if (job.deep)
+	{
+		text << " deep " << job.deep->maxIterations << " " << std::hexfloat << job.deep->zoom << " " << job.deep->center_real.toDouble() << " " << job.deep->center_imag.toDouble();
+	}
+	else
+	{
+		text << " float " << std::hexfloat << job.zoom << " " << job.frame_x << " " << job.frame_y;
+	}
+	text << " id " << job.id;
+	return text.str();
+}
+
+bool readCheckpoint(const std::string& path, const std::string& signature, ImageStream::State& state)
+{
+	std::ifstream file(path);
+	std::string magic;
+	std::string job;
+	if (!std::getline(file, magic) || magic != checkpointMagic || !std::getline(file, job) || job != signature)
+	{
+		return false;
+	}
+	return bool(file >> state.rows >> state.bytes >> state.adler);
+}
+
+// Written next to the checkpoint and renamed over it, so a kill never leaves a torn checkpoint
+bool writeCheckpoint(const std::string& path, const std::string& signature, const ImageStream::State& state)
+{
+	const std::string temporary = path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::trunc);
+		file << checkpointMagic << "\n" << signature << "\n" << state.rows << " " << state.bytes << " " << state.adler << "\n";
+		file.flush();
+		if (!file)
+		{
+			return false;
+		}
+	}
+	return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+}  // namespace
+
+/**
+ * Renders an image too large for memory. The calling thread calculates and colors one band
+ * at a time on the worker pool, a writer thread appends finished bands to the file and
+ * checkpoints after each one. At most posterQueueDepth bands wait for the writer, so the
+ * next bands are calculated while earlier ones are written without memory growing.
+ *
+ * @param job image size, view and output file
+ * @param stats optional output, bands rendered and buffer memory
+ * @param cancel optional flag, rendering stops after the current band and can be resumed
+ *
+ */
+bool renderPoster(const PosterJob& job, PosterStats* stats, const std::atomic<bool>* cancel)
+{
+	if (job.width <= 0 || job.height <= 0 || job.bandHeight <= 0)
+	{
+		return false;
+	}
+
+	const ImageFormat format = formatForPath(job.path);
+	const std::string checkpoint = job.checkpoint.empty() ? job.path + ".checkpoint" : job.checkpoint;
+	const std::string signature = describe(job, format);
+	const int maxIterations = job.deep ? job.deep->maxIterations : MAX_ITERATIONS;
+	PosterStats result;
+
+	ImageStream image;
+	ImageStream::State saved;
+	if (readCheckpoint(checkpoint, signature, saved) && image.resume(job.path, job.width, job.height, format, saved))
+	{
+		result.resumedRows = saved.rows;
+	}
+	else if (!image.open(job.path, job.width, job.height, format))
+	{
+		return false;
+	}
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<Band> queue;
+	bool producing = true;
+	bool failed = false;
+
+	std::thread writer([&]()
+	{
+		for (;;)
+		{
+			Band band;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&]() { return !queue.empty() || !producing; });
+				if (queue.empty())
+				{
+					return;
+				}
+				band = std::move(queue.front());
+				queue.pop_front();
+			}
+			changed.notify_all();
+
+			if (!image.writeRows(band.pixels.data(), band.rows) || !writeCheckpoint(checkpoint, signature, image.state()))
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				failed = true;
+				changed.notify_all();
+				return;
+			}
+		}
+	});
+
+	// one iteration band, one band being colored, the queue and the band the writer holds
+	const std::size_t bandPixels = std::size_t(job.width) * std::min(job.bandHeight, job.height);
+	result.bufferBytes = bandPixels * sizeof(uint16_t) + (posterQueueDepth + 2) * bandPixels * sizeof(uint32_t);
+
+	FrameBuffer frame(job.width, std::min(job.bandHeight, job.height), job.options.color.smooth);
+	ColorOptions colors = job.options.color;
+	colors.histogram = false;  // each band would be equalized on its own and the bands would not match
+	bool completed = true;
+	for (int top = image.state().rows; top < job.height && completed; top += job.bandHeight)
+	{
+		const int rows = std::min(job.bandHeight, job.height - top);
+		if (rows != frame.height())
+		{
+			frame.resize(job.width, rows);
+		}
+
+		completed = job.deep ? renderPerturbationBand(frame, top, job.height, *job.deep, cancel)
+		                     : renderBand(frame, top, job.height, job.zoom, job.frame_x, job.frame_y, job.options, cancel);
+		if (!completed)
+		{
+			break;
+		}
+
+		Band band{rows, std::vector<uint32_t>(std::size_t(job.width) * rows)};
+		colorize(frame, band.pixels.data(), maxIterations, colors);
+		++result.bands;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [&]() { return int(queue.size()) < posterQueueDepth || failed; });
+		completed = !failed;
+		if (completed)
+		{
+			queue.push_back(std::move(band));
+		}
+		lock.unlock();
+		changed.notify_all();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		producing = false;
+	}
+	changed.notify_all();
+	writer.join();
+
+	if (stats != nullptr)
+	{
+		*stats = result;
+	}
+	if (!completed || failed || !image.finish())
+	{
+		return false;
+	}
+	std::remove(checkpoint.c_str());
+	return true;
+}
+
+}  // namespace omp
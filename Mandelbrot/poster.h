@@ -0,0 +1,54 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Out-of-core renderer for print sized images
+             The image is calculated in horizontal bands that are colored and streamed to disk in order,
+             so memory depends on the band height and not on the image size
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "mandelbrot_omp.h"
+#include "perturbation.h"
+
+namespace omp {
+
+    // Image to render, the view maps onto it exactly like onto a width x height window
+    struct PosterJob
+    {
+        std::string path;                      // output image, PNG for ".png" and PPM otherwise
+        int width = 0;
+        int height = 0;
+        int bandHeight = 256;                  // rows calculated per band
+        float zoom = 1.f;                      // float view, ignored if deep is set
+        float frame_x = 0.f;
+        float frame_y = 0.f;
+        std::shared_ptr<const DeepView> deep;  // perturbation view for deep zooms
+        RenderOptions options;                 // kernel, tile size and interior checks, bands are always brute force
+        std::string checkpoint;                // progress file, path + ".checkpoint" if empty
+        std::string id;                        // identifies the view in the checkpoint, a checkpoint of another view is not resumed
+    };
+
+    struct PosterStats
+    {
+        int bands = 0;                 // bands calculated by this call
+        int resumedRows = 0;           // rows kept from an interrupted run
+        std::size_t bufferBytes = 0;   // band buffers held at most, independent of the image height
+    };
+
+    // Number of bands waiting for the writer thread at most, the renderer blocks while the queue is full
+    constexpr int posterQueueDepth = 2;
+
+    // Renders the job band by band while a writer thread streams finished bands to the file
+    // Progress is checkpointed after every band, calling again with the same job continues an interrupted render
+    // Returns: false on I/O errors or if cancelled, the checkpoint is removed once the image is complete
+    bool renderPoster(const PosterJob& job, PosterStats* stats = nullptr, const std::atomic<bool>* cancel = nullptr);
+
+}  // namespace omp
@@ -0,0 +1,157 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Coarse-to-fine refinement of the OpenMP Mandelbrot renderer for interactive views
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include "mariani_silver.h"
+#include "progressive.h"
+#include "symmetry.h"
+#include "trace.h"
+
+namespace omp {
+
+namespace {
+
+/**
+ * Calculates the samples of one pass inside a tile and fills their blocks.
+ * Samples on the grid of the previous (twice as coarse) pass are reused.
+ *
+ * @param frame iteration buffer of the view
+ * @param tile pixels to refine, aligned to the coarsest step
+ * @param step block size of this pass
+ * @param reuse true if the samples on the 2*step grid were already calculated
+ * @param options resolved kernel, interior checks and formula
+ * @param mirror full resolution pass only: rows that are copied from their mirror image afterwards are skipped (see mirrorRows)
+ * 
+ */
+void refineTile(FrameBuffer& frame, const Tile& tile, int step, bool reuse, float zoom, float frame_x, float frame_y, const RenderOptions& options, const std::vector<int>& mirror)
+{
+	TRACE_SCOPE("refine tile");
+	const int minDim = std::min(frame.width(), frame.height());
+	const int right = tile.x + tile.width;
+	const int bottom = tile.y + tile.height;
+	std::vector<uint16_t> iterations(tile.width);
+	std::vector<float> smooth(frame.hasSmooth() ? tile.width : 0);
+	uint64_t executed = 0;
+
+	for (int y = tile.y; y < bottom; y += step)
+	{
+		const bool coarseRow = reuse && (y % (2 * step) == 0);
+		const int first = coarseRow ? tile.x + step : tile.x;
+		const int spacing = coarseRow ? 2 * step : step;
+		if (first >= right || (step == 1 && !mirror.empty() && mirror[y] >= 0))
+		{
+			continue;
+		}
+
+		const int count = (right - first + spacing - 1) / spacing;
+		executed += calculateRow(options, iterations.data(), smooth.empty() ? nullptr : smooth.data(), first, y, count, minDim, minDim, zoom, frame_x, frame_y, spacing);
+
+		const int rows = std::min(step, bottom - y);
+		for (int dy = 0; dy < rows; ++dy)
+		{
+			uint16_t* row = frame.row(y + dy);
+			float* smooth_row = frame.smoothRow(y + dy);
+			for (int k = 0; k < count; ++k)
+			{
+				const int x = first + k * spacing;
+				const int cols = std::min(step, right - x);
+				std::fill(row + x, row + x + cols, iterations[k]);
+				if (smooth_row != nullptr)
+				{
+					std::fill(smooth_row + x, smooth_row + x + cols, smooth[k]);
+				}
+			}
+		}
+	}
+	TRACE_COUNT("tiles", 1);
+	TRACE_COUNT("iterations", int64_t(executed));
+}
+
+}  // namespace
+
+/**
+ * Renders the next refinement pass of the view.
+ *
+ * @param frame iteration buffer of the view
+ * @param zoom scaling factor of fractal 
+ * @param frame_x controls where to render fractal in x -changed via panning
+ * @param frame_y controls where to render fractal in y-changed via panning
+ * @param options kernel, tile size and interior checks
+ * @param cancel optional flag, the pass is abandoned (and will be repeated) once it is set
+ * 
+ */
+bool ProgressiveRenderer::renderNextPass(FrameBuffer& frame, float zoom, float frame_x, float frame_y, const RenderOptions& options, const std::atomic<bool>* cancel)
+{
+	if (step == 0)
+	{
+		return false;
+	}
+
+	if (options.algorithm == Algorithm::MARIANI_SILVER && classicFormula(options.formula))
+	{
+		// subdivision already skips most of the work, render the exact image in one pass
+		if (!marianiSilver(frame, zoom, frame_x, frame_y, options, cancel))
+		{
+			return false;
+		}
+		lastStep = 1;
+		step = 0;
+		return true;
+	}
+
+	const int pass = step;
+	const bool reuse = pass < coarsestStep;
+	RenderOptions resolved = options;
+	resolved.kernel = resolveKernel(options.kernel);
+	const int tileSize = std::max(coarsestStep, (options.tileSize + coarsestStep - 1) / coarsestStep * coarsestStep);
+
+	std::vector<Tile> tiles = TileScheduler::makeTiles(frame.width(), frame.height(), tileSize);
+	if (reuse)
+	{
+		// the coarsest samples are already in the buffer, use them as the cost estimate
+		for (Tile& tile : tiles)
+		{
+			for (int y = tile.y; y < tile.y + tile.height; y += coarsestStep)
+			{
+				for (int x = tile.x; x < tile.x + tile.width; x += coarsestStep)
+				{
+					tile.cost += frame.at(x, y) + 1;
+				}
+			}
+		}
+	}
+
+	// the full resolution pass skips rows that mirror other rows about the real axis and copies them once the pass is done
+	std::vector<int> mirror;
+	if (pass == 1 && options.symmetry && formulaMirrorsRows(options.formula))
+	{
+		mirror = mirrorRows(frame.height(), std::min(frame.width(), frame.height()), zoom, frame_y);
+		for (Tile& tile : tiles)
+		{
+			tile.cost = tile.cost * std::count(mirror.begin() + tile.y, mirror.begin() + tile.y + tile.height, -1) / tile.height;
+		}
+	}
+
+	const bool completed = TileScheduler::instance().run(std::move(tiles), [&](const Tile& tile)
+	{
+		refineTile(frame, tile, pass, reuse, zoom, frame_x, frame_y, resolved, mirror);
+	}, cancel);
+	if (!completed)
+	{
+		return false;
+	}
+	copyMirroredRows(frame, mirror);
+
+	lastStep = pass;
+	step = pass / 2;
+	return true;
+}
+
+}  // namespace omp
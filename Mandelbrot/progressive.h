@@ -0,0 +1,46 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Coarse-to-fine refinement of the OpenMP Mandelbrot renderer for interactive views
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include "mandelbrot_omp.h"
+
+namespace omp {
+
+    // Renders a view in passes of 1/8, 1/4, 1/2 and full resolution
+    // Each pass only calculates the samples the previous passes did not, the rest of the
+    // block around every sample is filled with its value until a finer pass replaces it
+    // Mariani-Silver rendering skips the coarse passes and renders the exact image at once
+    class ProgressiveRenderer
+    {
+        public:
+            static constexpr int coarsestStep = 8;
+
+            ProgressiveRenderer() : step(0), lastStep(0) {}
+
+            // Starts refining a new view from the coarsest pass
+            void restart() { step = coarsestStep; lastStep = 0; }
+
+            // Renders the next pass into the frame buffer, the frame must not change size between passes
+            // Returns: false if the view was already at full resolution or the pass was cancelled
+            bool renderNextPass(FrameBuffer& frame, float zoom, float frame_x, float frame_y, const RenderOptions& options = RenderOptions(), const std::atomic<bool>* cancel = nullptr);
+
+            // True once the full resolution pass has completed
+            bool done() const { return step == 0; }
+
+            // Block size of the last completed pass, 1 for the exact image, 0 if nothing was rendered yet
+            int lastCompletedStep() const { return lastStep; }
+
+        private:
+            int step;      // block size of the next pass, 0 when finished
+            int lastStep;
+    };
+
+}  // namespace omp
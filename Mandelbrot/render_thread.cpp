@@ -0,0 +1,302 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Dedicated producer thread for the OpenMP Mandelbrot renderer
+             Views are posted through a lock-free single-slot mailbox and finished frames are
+             handed back the same way, so a slow frame never blocks the SFML event loop
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "perturbation.h"
+#include "render_thread.h"
+#include "trace.h"
+
+namespace omp {
+
+namespace {
+
+constexpr double panTolerance = 1e-3;  // pixels, a pan is only reused if it is this close to the pixel grid
+
+/**
+ * Detects a pan by whole pixels between two views.
+ *
+ * @param previous view the frame buffer currently holds
+ * @param next view to render
+ * @param dx set to the columns the view moved
+ * @param dy set to the rows the view moved
+ * 
+ */
+bool pixelShift(const View& previous, const View& next, int& dx, int& dy)
+{
+	if (previous.deep || next.deep || previous.width != next.width || previous.height != next.height || previous.zoom != next.zoom || previous.options.kernel != next.options.kernel
+		|| previous.options.algorithm != next.options.algorithm || previous.options.interior.cardioid != next.options.interior.cardioid
+		|| previous.options.interior.periodicity != next.options.interior.periodicity || previous.options.tileCache != next.options.tileCache
+		|| previous.options.formula != next.options.formula)
+	{
+		return false;
+	}
+
+	// inverse of pixelToReal/pixelToImag: one pixel is zoom / minDim in frame units
+	const double minDim = std::min(next.width, next.height);
+	const double shift_x = (double(next.frame_x) - double(previous.frame_x)) * minDim / next.zoom;
+	const double shift_y = -(double(next.frame_y) - double(previous.frame_y)) * minDim / next.zoom;
+	if (std::abs(shift_x) >= next.width || std::abs(shift_y) >= next.height)
+	{
+		return false;
+	}
+
+	dx = int(std::lround(shift_x));
+	dy = int(std::lround(shift_y));
+	return std::abs(shift_x - dx) < panTolerance && std::abs(shift_y - dy) < panTolerance;
+}
+
+/**
+ * Detects a view that only differs from the previous one in its colors, the frame buffer
+ * then already holds its iterations and is just colored again.
+ *
+ * @param previous view the frame buffer currently holds
+ * @param next view to render
+ * 
+ */
+bool recolorOnly(const View& previous, const View& next)
+{
+	if (previous.deep || next.deep)
+	{
+		return previous.deep && next.deep && previous.width == next.width && previous.height == next.height && previous.deep->zoom == next.deep->zoom
+			&& previous.deep->maxIterations == next.deep->maxIterations && (previous.deep->center_real - next.deep->center_real).isZero()
+			&& (previous.deep->center_imag - next.deep->center_imag).isZero();
+	}
+	int dx = 0;
+	int dy = 0;
+	return pixelShift(previous, next, dx, dy) && dx == 0 && dy == 0;
+}
+
+/**
+ * Calculates the L-shaped region uncovered by a pan: a full height strip of |dx| columns
+ * and a strip of |dy| rows across the remaining columns.
+ */
+bool renderExposed(FrameBuffer& frame, int dx, int dy, const View& view, const std::atomic<bool>* cancel)
+{
+	const int width = frame.width();
+	const int height = frame.height();
+	bool completed = true;
+	if (dx != 0)
+	{
+		completed = renderRegion(frame, (dx > 0) ? width - dx : 0, 0, std::abs(dx), height, view.zoom, view.frame_x, view.frame_y, view.options, cancel);
+	}
+	if (dy != 0 && completed)
+	{
+		completed = renderRegion(frame, std::max(-dx, 0), (dy > 0) ? height - dy : 0, width - std::abs(dx), std::abs(dy), view.zoom, view.frame_x, view.frame_y, view.options, cancel);
+	}
+	return completed;
+}
+
+}  // namespace
+
+RenderThread::RenderThread() : mailbox(nullptr), ready(nullptr), spare(nullptr), cancel(false), busy(false), stopping(false)
+{
+	thread = std::thread(&RenderThread::loop, this);
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	cancel.store(true);
+	wakeup.notify_one();
+	thread.join();
+
+	delete mailbox.exchange(nullptr);
+	delete ready.exchange(nullptr);
+	delete spare.exchange(nullptr);
+}
+
+/**
+ * Replaces the view in the mailbox. Only the newest view is kept, views the render
+ * thread never picked up are dropped.
+ *
+ * @param view snapshot of the window state
+ * 
+ */
+void RenderThread::submit(const View& view)
+{
+	delete mailbox.exchange(new View(view));
+	cancel.store(true);
+	{
+		std::lock_guard<std::mutex> lock(mutex);  // pairs with the wait in loop so the wakeup is not lost
+		busy.store(true);
+	}
+	wakeup.notify_one();
+}
+
+void RenderThread::clear()
+{
+	this->submit(View());
+	this->recycle(std::unique_ptr<Frame>(ready.exchange(nullptr)));
+}
+
+std::unique_ptr<Frame> RenderThread::takeFrame()
+{
+	return std::unique_ptr<Frame>(ready.exchange(nullptr));
+}
+
+bool RenderThread::idle() const
+{
+	// the last frame is published before busy drops, so an idle thread with an empty slot has nothing left to deliver
+	return !busy.load() && ready.load() == nullptr;
+}
+
+void RenderThread::waitForFrame(std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	published.wait_for(lock, timeout, [this] { return ready.load() != nullptr || !busy.load(); });
+}
+
+void RenderThread::recycle(std::unique_ptr<Frame> frame)
+{
+	if (frame)
+	{
+		delete spare.exchange(frame.release());
+	}
+}
+
+/**
+ * Render loop. Picks up the newest view, renders it pass by pass and publishes every
+ * completed pass. A pass abandoned because of a newer view is never published.
+ * If the frame buffer holds the exact image of the previous view and the new view is a
+ * pan by whole pixels, the buffer is shifted and only the exposed strips are calculated.
+ * Views that snap to the tile pyramid are assembled from the tile cache instead when it is enabled.
+ * A view that only changes the colors recolors the frame buffer without iterating.
+ * Deep views are rendered by perturbation in a single pass.
+ */
+void RenderThread::loop()
+{
+	FrameBuffer frame;
+	ProgressiveRenderer progressive;
+	View view;
+	bool exact = false;  // frame holds the full resolution image of view
+#if FRACTAL_TRACING
+	trace::setThreadName("render");
+#endif
+
+	while (true)
+	{
+		cancel.store(false);
+		std::unique_ptr<View> next(mailbox.exchange(nullptr));
+		if (next)
+		{
+			int dx = 0;
+			int dy = 0;
+			PyramidPosition position;
+			// cached tiles hold counts only, smooth coloring calculates the view
+			const bool cached = next->options.tileCache && classicFormula(next->options.formula) && !next->options.color.smooth && snapToPyramid(*next, position);
+			const bool reusable = exact && (!next->options.color.smooth || frame.hasSmooth());  // the frame holds every count the next view needs
+			const bool recolor = reusable && recolorOnly(view, *next);
+			const bool pan = reusable && !cached && !recolor && pixelShift(view, *next, dx, dy);
+			view = *next;
+			exact = false;
+			if (recolor)
+			{
+				TRACE_SCOPE("recolor");
+				exact = true;
+				this->publish(view, frame, 1);
+				continue;
+			}
+			if (pan)
+			{
+				TRACE_SCOPE("pan");
+				frame.shift(dx, dy);
+				exact = renderExposed(frame, dx, dy, view, &cancel);
+				if (exact)
+				{
+					this->publish(view, frame, 1);
+					continue;
+				}
+			}
+
+			frame.resize(view.width, view.height);
+			frame.enableSmooth(view.options.color.smooth);
+			progressive.restart();
+			if (cached)
+			{
+				// a cancelled assembly falls back to refinement, which the newer view cancels right away
+				TRACE_SCOPE("cache assembly");
+				exact = cache.render(frame, view, position, &cancel);
+				if (exact)
+				{
+					this->publish(view, frame, 1);
+					continue;
+				}
+			}
+		}
+
+		if (view.width <= 0 || view.height <= 0 || exact || (!view.deep && progressive.done()))
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (mailbox.load() == nullptr)
+			{
+				busy.store(false);  // submit raises it again under the same lock
+				published.notify_all();
+			}
+			wakeup.wait(lock, [this] { return stopping || mailbox.load() != nullptr; });
+			if (stopping)
+			{
+				return;
+			}
+			continue;
+		}
+
+		TRACE_SCOPE("render pass");
+		if (view.deep)
+		{
+			exact = renderPerturbation(frame, *view.deep, &cancel);
+			if (exact)
+			{
+				this->publish(view, frame, 1);
+			}
+		}
+		else if (progressive.renderNextPass(frame, view.zoom, view.frame_x, view.frame_y, view.options, &cancel))
+		{
+			exact = progressive.done();
+			this->publish(view, frame, progressive.lastCompletedStep());
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stopping)
+		{
+			return;
+		}
+	}
+}
+
+// Colors the frame into a recycled buffer and swaps it into the ready slot
+void RenderThread::publish(const View& view, const FrameBuffer& frame, int step)
+{
+	TRACE_SCOPE("publish");
+	std::unique_ptr<Frame> finished(spare.exchange(nullptr));
+	if (!finished)
+	{
+		finished.reset(new Frame());
+	}
+
+	finished->view = view;
+	finished->step = step;
+	finished->pixels.resize(std::size_t(view.width) * view.height);
+	colorize(frame, finished->pixels.data(), view.deep ? view.deep->maxIterations : MAX_ITERATIONS, view.options.color);
+
+	// a frame the UI never took is stale now, keep its storage for the next pass
+	this->recycle(std::unique_ptr<Frame>(ready.exchange(finished.release())));
+	{
+		std::lock_guard<std::mutex> lock(mutex);  // pairs with the wait in waitForFrame so the wakeup is not lost
+	}
+	published.notify_all();
+}
+
+}  // namespace omp
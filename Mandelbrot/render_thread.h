@@ -0,0 +1,82 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Dedicated producer thread for the OpenMP Mandelbrot renderer
+             Views are posted through a lock-free single-slot mailbox and finished frames are
+             handed back the same way, so a slow frame never blocks the SFML event loop
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mandelbrot_omp.h"
+#include "progressive.h"
+#include "tile_cache.h"
+
+namespace omp {
+
+    // Colored frame produced by the render thread
+    struct Frame
+    {
+        View view;                     // view the frame was rendered for
+        int step = 0;                  // block size of the refinement pass, 1 when exact
+        std::vector<uint32_t> pixels;  // view.width*view.height packed RGBA pixels, row 0 is the top
+    };
+
+    class RenderThread
+    {
+        public:
+            RenderThread();
+            ~RenderThread();
+            RenderThread(const RenderThread&) = delete;
+            RenderThread& operator=(const RenderThread&) = delete;
+
+            // Posts the latest view, a render of an older view is cancelled at the next tile
+            void submit(const View& view);
+
+            // Stops rendering and drops any frame that was not taken yet
+            void clear();
+
+            // Takes the newest finished frame, nullptr if there is none
+            std::unique_ptr<Frame> takeFrame();
+
+            // Returns: true once the newest view is fully rendered and its last frame was taken, nothing will arrive until the next submit
+            bool idle() const;
+
+            // Blocks until a frame is ready, the thread goes idle or the timeout passes
+            void waitForFrame(std::chrono::milliseconds timeout);
+
+            // Hands a presented frame back so its pixel storage can be reused
+            void recycle(std::unique_ptr<Frame> frame);
+
+            // Tiles of views rendered with RenderOptions::tileCache, kept across views and modes
+            TileCache& tileCache() { return cache; }
+
+        private:
+            std::atomic<View*> mailbox;  // newest view not yet picked up by the render thread
+            std::atomic<Frame*> ready;   // newest finished frame not yet taken by the UI thread
+            std::atomic<Frame*> spare;   // presented frame waiting to be reused
+            std::atomic<bool> cancel;    // raised when a newer view arrives
+            std::atomic<bool> busy;      // a submitted view is not fully rendered yet, only changed under mutex
+            TileCache cache;
+
+            std::mutex mutex;  // only used to sleep, while there is nothing to render or no frame to present
+            std::condition_variable wakeup;
+            std::condition_variable published;  // a frame was published or the thread went idle
+            bool stopping;
+            std::thread thread;
+
+            void loop();
+            void publish(const View& view, const FrameBuffer& frame, int step);
+    };
+
+}  // namespace omp
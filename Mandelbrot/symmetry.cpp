@@ -0,0 +1,93 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Mirror symmetry of the Mandelbrot set about the real axis for the OpenMP renderer
+             Rows whose imaginary part is exactly the negated imaginary part of another row are
+             copied from that row instead of being calculated
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "symmetry.h"
+
+namespace omp {
+
+/**
+ * Pairs the rows of a view about the real axis. The axis is the (possibly fractional) row
+ * where pixelToImag crosses zero, rows j and k - j are candidates when k is twice the axis
+ * rounded, and a pair is only used if the float coordinates of its rows negate exactly.
+ * If the rows of a pair differ in parity the odd row becomes the copy, because the last
+ * progressive pass calculates odd rows in full and only half of every even row.
+ *
+ * @param height rows of the frame
+ * @param minDim pixel scale of the mapping, min(width, height)
+ * @param zoom scaling factor of fractal
+ * @param frame_y controls where to render fractal in y-changed via panning
+ *
+ */
+std::vector<int> mirrorRows(int height, int minDim, float zoom, float frame_y)
+{
+	std::vector<int> mirror(std::max(height, 0), -1);
+
+	// pixelToImag(j) = ((j / minDim - 0.5) * zoom - frame_y) * 5 is zero at j = minDim * (0.5 + frame_y / zoom)
+	const double axis = minDim * (0.5 + double(frame_y) / zoom);
+	if (!(axis > -height && axis < 2.0 * height))
+	{
+		return mirror;  // the view does not overlap its mirror image
+	}
+
+	const long long k = std::llround(2.0 * axis);
+	for (int j = std::max<long long>(0, k - height + 1); j < height && 2LL * j < k; ++j)
+	{
+		const int m = int(k - j);
+		if (pixelToImag(m, minDim, zoom, frame_y) != -pixelToImag(j, minDim, zoom, frame_y))
+		{
+			continue;
+		}
+
+		if (((j ^ m) & 1) != 0 && (j & 1) != 0)
+		{
+			mirror[j] = m;
+		}
+		else
+		{
+			mirror[m] = j;
+		}
+	}
+	return mirror;
+}
+
+int mirroredRowCount(const std::vector<int>& mirror)
+{
+	return int(std::count_if(mirror.begin(), mirror.end(), [](int source) { return source >= 0; }));
+}
+
+/**
+ * Fills the mirrored rows of a frame from their source rows.
+ *
+ * @param frame iteration buffer whose source rows are calculated
+ * @param mirror row mapping from mirrorRows for this frame
+ *
+ */
+void copyMirroredRows(FrameBuffer& frame, const std::vector<int>& mirror)
+{
+	const std::size_t width = std::size_t(frame.width());
+	for (int y = 0; y < int(mirror.size()); ++y)
+	{
+		if (mirror[y] < 0)
+		{
+			continue;
+		}
+		std::memcpy(frame.row(y), frame.row(mirror[y]), width * sizeof(uint16_t));
+		if (frame.hasSmooth())
+		{
+			std::memcpy(frame.smoothRow(y), frame.smoothRow(mirror[y]), width * sizeof(float));
+		}
+	}
+}
+
+}  // namespace omp
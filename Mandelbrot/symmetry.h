@@ -0,0 +1,31 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Mirror symmetry of the Mandelbrot set about the real axis for the OpenMP renderer
+             Rows whose imaginary part is exactly the negated imaginary part of another row are
+             copied from that row instead of being calculated
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "mandelbrot_omp.h"
+
+namespace omp {
+
+    // Every kernel treats c and its conjugate alike (negation is exact in IEEE arithmetic), so a row whose pixelToImag is
+    // exactly the negation of another row's has the same counts bit for bit. Rows of a view straddling the real axis pair up
+    // about the axis row, pairs whose float coordinates are not exact negations (or an axis off the half-pixel grid) are calculated
+    // Returns: for every row the row to copy it from, or -1 if it must be calculated. Source rows are never copies themselves
+    std::vector<int> mirrorRows(int height, int minDim, float zoom, float frame_y);
+
+    // Returns: number of rows mirrorRows maps to a source row
+    int mirroredRowCount(const std::vector<int>& mirror);
+
+    // Copies every mirrored row, with its smooth values, from its source row once the sources are calculated
+    void copyMirroredRows(FrameBuffer& frame, const std::vector<int>& mirror);
+
+}  // namespace omp
@@ -0,0 +1,306 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: In-memory cache of iteration tiles on a power-of-two pyramid
+             Views that snap to the pyramid are assembled from cached tiles, only missing tiles are calculated
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "tile_cache.h"
+#include "tile_store.h"
+#include "trace.h"
+
+namespace omp {
+
+namespace {
+
+constexpr double snapTolerance = 0.05;  // pixels, how far a view may sit from the pyramid grid and still snap
+
+int64_t floorDiv(int64_t a, int64_t b)
+{
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+std::size_t tileBytes(const FrameBuffer& tile)
+{
+	return std::size_t(tile.stride()) * tile.height() * sizeof(uint16_t);
+}
+
+}  // namespace
+
+/**
+ * Calculates pyramid tiles together on the worker pool. Each tile is a 256 x 256 view of
+ * its own, so the result does not depend on the window or job it was requested for.
+ *
+ * @param keys tiles to calculate, levels may differ
+ * @param tiles one pyramidTileSize square buffer per key, receives the iterations
+ * @param options kernel, tile size and interior checks
+ * @param cancel optional flag, remaining work is skipped once it is set
+ *
+ */
+bool renderPyramidTiles(const std::vector<TileKey>& keys, const std::vector<std::shared_ptr<FrameBuffer>>& tiles, const RenderOptions& options, const std::atomic<bool>* cancel)
+{
+	RenderOptions resolved = options;
+	resolved.kernel = resolveKernel(options.kernel);
+
+	// the tiles are laid side by side so their sub-tiles share one run
+	std::vector<Tile> work;
+	for (std::size_t m = 0; m < keys.size(); ++m)
+	{
+		for (Tile tile : TileScheduler::makeTiles(pyramidTileSize, pyramidTileSize, options.tileSize))
+		{
+			tile.x += int(m) * pyramidTileSize;
+			work.push_back(tile);
+		}
+	}
+	return TileScheduler::instance().run(std::move(work), [&](const Tile& tile)
+	{
+		const std::size_t m = std::size_t(tile.x / pyramidTileSize);
+		const TileKey& key = keys[m];
+		const float zoom = float(std::ldexp(1.0, -key.level));
+		Tile local = tile;
+		local.x -= int(m) * pyramidTileSize;
+		renderTile(*tiles[m], local, zoom, float((key.tx + 0.5) * zoom), float(-(key.ty + 0.5) * zoom), resolved);
+	}, cancel);
+}
+
+std::size_t TileKeyHash::operator()(const TileKey& key) const
+{
+	// FNV-1a over the fields, tx and ty dominate so they are mixed last
+	uint64_t hash = 14695981039346656037ull;
+	const uint64_t fields[] = {uint64_t(key.fractal), uint64_t(key.level), uint64_t(key.maxIterations),
+		uint64_t(key.interior.cardioid) | (uint64_t(key.interior.periodicity) << 1), uint64_t(key.tx), uint64_t(key.ty)};
+	for (uint64_t field : fields)
+	{
+		hash = (hash ^ field) * 1099511628211ull;
+	}
+	return std::size_t(hash);
+}
+
+/**
+ * Checks whether a view is a window onto the pyramid: its pixel spacing must be the
+ * spacing of a pyramid level and its corner must sit on that level's pixel grid.
+ * Same mapping as pixelToReal/pixelToImag with width and height both set to minDim.
+ *
+ * @param view snapshot of the window
+ * @param position set to the level and pyramid pixel of the top left corner
+ *
+ */
+bool snapToPyramid(const View& view, PyramidPosition& position)
+{
+	if (view.deep || view.width <= 0 || view.height <= 0)
+	{
+		return false;
+	}
+
+	const int minDim = std::min(view.width, view.height);
+	const double spacing = double(view.zoom) / minDim * pyramidTileSize;  // 2^-level if the view snaps
+	const int level = int(std::lround(-std::log2(spacing)));
+	if (level < 0 || level > pyramidMaxLevel || std::abs(std::ldexp(spacing, level) - 1.0) > 1e-5)
+	{
+		return false;
+	}
+
+	const double pixel = std::ldexp(1.0, -level) / pyramidTileSize;
+	const double origin_x = view.frame_x / pixel - minDim / 2.0;
+	const double origin_y = -view.frame_y / pixel - minDim / 2.0;
+	const double x = std::round(origin_x);
+	const double y = std::round(origin_y);
+
+	// deep levels have pixels finer than the float frame coordinates, allow for their rounding
+	const double tolerance_x = snapTolerance + (std::nextafter(std::abs(view.frame_x), 2.0f) - std::abs(view.frame_x)) / pixel;
+	const double tolerance_y = snapTolerance + (std::nextafter(std::abs(view.frame_y), 2.0f) - std::abs(view.frame_y)) / pixel;
+	if (std::abs(origin_x - x) > tolerance_x || std::abs(origin_y - y) > tolerance_y)
+	{
+		return false;
+	}
+
+	position.level = level;
+	position.x = int64_t(x);
+	position.y = int64_t(y);
+	return true;
+}
+
+std::shared_ptr<const FrameBuffer> TileCache::find(const TileKey& key)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto entry = index.find(key);
+	if (entry == index.end())
+	{
+		++counters.misses;
+		TRACE_COUNT("cache misses", 1);
+		return nullptr;
+	}
+	++counters.hits;
+	TRACE_COUNT("cache hits", 1);
+	lru.splice(lru.begin(), lru, entry->second);
+	return entry->second->second;
+}
+
+void TileCache::insert(const TileKey& key, std::shared_ptr<const FrameBuffer> tile)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto entry = index.find(key);
+	if (entry != index.end())
+	{
+		bytes -= tileBytes(*entry->second->second);
+		lru.erase(entry->second);
+		index.erase(entry);
+	}
+
+	bytes += tileBytes(*tile);
+	lru.emplace_front(key, std::move(tile));
+	index[key] = lru.begin();
+	this->evict();
+}
+
+void TileCache::attachStore(std::shared_ptr<TileStore> store)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->store = std::move(store);
+}
+
+void TileCache::setBudget(std::size_t budget)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->budget = budget;
+	this->evict();
+}
+
+void TileCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	lru.clear();
+	index.clear();
+	bytes = 0;
+}
+
+TileCache::Stats TileCache::stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Stats result = counters;
+	result.bytes = bytes;
+	result.tiles = lru.size();
+	return result;
+}
+
+// Drops least recently used tiles until the cache fits its budget, the caller holds the mutex
+void TileCache::evict()
+{
+	while (bytes > budget && !lru.empty())
+	{
+		bytes -= tileBytes(*lru.back().second);
+		index.erase(lru.back().first);
+		lru.pop_back();
+		++counters.evictions;
+	}
+}
+
+/**
+ * Assembles a snapped view. Every tile the view overlaps is looked up, the missing ones
+ * are decoded from the attached pyramid file if it holds them, otherwise calculated
+ * together on the worker pool, then cached and copied in.
+ *
+ * @param frame iteration buffer of the view
+ * @param view snapshot of the window, its kernel, tile size and interior checks are used
+ * @param position pyramid position returned by snapToPyramid
+ * @param cancel optional flag, nothing is cached or copied once it is set
+ *
+ */
+bool TileCache::render(FrameBuffer& frame, const View& view, const PyramidPosition& position, const std::atomic<bool>* cancel)
+{
+	const int64_t size = pyramidTileSize;
+	const int64_t tx0 = floorDiv(position.x, size);
+	const int64_t ty0 = floorDiv(position.y, size);
+	const int columns = int(floorDiv(position.x + frame.width() - 1, size) - tx0 + 1);
+	const int rows = int(floorDiv(position.y + frame.height() - 1, size) - ty0 + 1);
+
+	std::shared_ptr<TileStore> file;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		file = store;
+	}
+	if (file)
+	{
+		file->refresh();  // another process may be appending to it
+	}
+
+	std::vector<TileKey> keys(std::size_t(columns) * rows);
+	std::vector<std::shared_ptr<const FrameBuffer>> tiles(keys.size());
+	std::vector<std::size_t> missing;
+	std::vector<std::shared_ptr<FrameBuffer>> calculated;
+	for (int row = 0; row < rows; ++row)
+	{
+		for (int column = 0; column < columns; ++column)
+		{
+			const std::size_t k = std::size_t(row) * columns + column;
+			keys[k].level = position.level;
+			keys[k].tx = tx0 + column;
+			keys[k].ty = ty0 + row;
+			keys[k].interior = view.options.interior;
+			tiles[k] = this->find(keys[k]);
+			if (!tiles[k] && file)
+			{
+				std::shared_ptr<FrameBuffer> loaded = std::make_shared<FrameBuffer>(pyramidTileSize, pyramidTileSize);
+				if (file->load(keys[k], *loaded))
+				{
+					tiles[k] = loaded;
+					this->insert(keys[k], loaded);
+					std::lock_guard<std::mutex> lock(mutex);
+					++counters.loaded;
+				}
+			}
+			if (!tiles[k])
+			{
+				missing.push_back(k);
+				calculated.push_back(std::make_shared<FrameBuffer>(pyramidTileSize, pyramidTileSize));
+			}
+		}
+	}
+
+	if (!missing.empty())
+	{
+		std::vector<TileKey> missingKeys;
+		for (std::size_t k : missing)
+		{
+			missingKeys.push_back(keys[k]);
+		}
+		if (!renderPyramidTiles(missingKeys, calculated, view.options, cancel))
+		{
+			return false;
+		}
+
+		for (std::size_t m = 0; m < missing.size(); ++m)
+		{
+			tiles[missing[m]] = calculated[m];
+			this->insert(keys[missing[m]], calculated[m]);
+		}
+	}
+
+	for (int row = 0; row < rows; ++row)
+	{
+		for (int column = 0; column < columns; ++column)
+		{
+			const FrameBuffer& tile = *tiles[std::size_t(row) * columns + column];
+			const int64_t left = (tx0 + column) * size - position.x;  // tile origin in frame pixels
+			const int64_t top = (ty0 + row) * size - position.y;
+			const int x0 = int(std::max<int64_t>(left, 0));
+			const int x1 = int(std::min<int64_t>(left + size, frame.width()));
+			const int y0 = int(std::max<int64_t>(top, 0));
+			const int y1 = int(std::min<int64_t>(top + size, frame.height()));
+			for (int y = y0; y < y1; ++y)
+			{
+				std::memcpy(frame.row(y) + x0, tile.row(int(y - top)) + (x0 - left), std::size_t(x1 - x0) * sizeof(uint16_t));
+			}
+		}
+	}
+	return true;
+}
+
+}  // namespace omp
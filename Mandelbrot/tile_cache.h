@@ -0,0 +1,128 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: In-memory cache of iteration tiles on a power-of-two pyramid
+             Views that snap to the pyramid are assembled from cached tiles, only missing tiles are calculated
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "mandelbrot_omp.h"
+
+namespace omp {
+
+    // Edge length of a pyramid tile, a tile of level L is the 256 x 256 view with zoom 2^-L
+    constexpr int pyramidTileSize = 256;
+
+    // Deepest pyramid level, float frame coordinates of the tiles stay exact up to here
+    constexpr int pyramidMaxLevel = 22;
+
+    enum class Fractal : uint8_t
+    {
+        MANDELBROT
+    };
+
+    // Identifies one tile of the pyramid, rows grow towards positive imaginary values like frame rows
+    struct TileKey
+    {
+        Fractal fractal = Fractal::MANDELBROT;
+        int level = 0;           // pixel spacing is 2^-level / pyramidTileSize in frame units
+        int64_t tx = 0;          // tile column, tile (0, 0) starts at frame coordinate (0, 0)
+        int64_t ty = 0;          // tile row
+        int maxIterations = MAX_ITERATIONS;
+        InteriorChecks interior;  // periodicity detection may change counts, so it is part of the key
+
+        bool operator==(const TileKey& other) const
+        {
+            return fractal == other.fractal && level == other.level && tx == other.tx && ty == other.ty && maxIterations == other.maxIterations
+                && interior.cardioid == other.interior.cardioid && interior.periodicity == other.interior.periodicity;
+        }
+    };
+
+    struct TileKeyHash
+    {
+        std::size_t operator()(const TileKey& key) const;
+    };
+
+    class TileStore;
+
+    // Position of a view that snaps to the pyramid
+    struct PyramidPosition
+    {
+        int level = 0;
+        int64_t x = 0;  // pyramid pixel of the top left corner of the view
+        int64_t y = 0;
+    };
+
+    // Returns true if the view's pixels fall on the pixel grid of a pyramid level
+    bool snapToPyramid(const View& view, PyramidPosition& position);
+
+    // Calculates pyramid tiles on the worker pool, tiles[k] is a pyramidTileSize square buffer that receives keys[k]
+    // Returns: false if cancelled
+    bool renderPyramidTiles(const std::vector<TileKey>& keys, const std::vector<std::shared_ptr<FrameBuffer>>& tiles, const RenderOptions& options, const std::atomic<bool>* cancel = nullptr);
+
+    // Bounded least recently used cache of pyramid tiles, safe to use from several threads
+    class TileCache
+    {
+        public:
+            static constexpr std::size_t defaultBudget = std::size_t(64) << 20;  // bytes
+
+            struct Stats
+            {
+                uint64_t hits = 0;
+                uint64_t misses = 0;
+                uint64_t evictions = 0;
+                uint64_t loaded = 0;    // misses served from the attached pyramid file
+                std::size_t bytes = 0;  // iteration data currently held
+                std::size_t tiles = 0;
+            };
+
+            explicit TileCache(std::size_t budget = defaultBudget) : budget(budget), bytes(0) {}
+            TileCache(const TileCache&) = delete;
+            TileCache& operator=(const TileCache&) = delete;
+
+            // Returns the tile and marks it most recently used, nullptr (and a miss) if it is not cached
+            std::shared_ptr<const FrameBuffer> find(const TileKey& key);
+
+            // Stores a tile, least recently used tiles are evicted until the cache fits its budget
+            void insert(const TileKey& key, std::shared_ptr<const FrameBuffer> tile);
+
+            // Serves misses from a pyramid file before calculating them, nullptr detaches it
+            void attachStore(std::shared_ptr<TileStore> store);
+
+            // Changes the byte budget, evicting tiles if the cache no longer fits
+            void setBudget(std::size_t budget);
+
+            void clear();
+            Stats stats() const;
+
+            // Fills a view that snaps to the pyramid from cached tiles, missing tiles are loaded from the store or calculated on the worker pool
+            // Returns: false if cancelled
+            bool render(FrameBuffer& frame, const View& view, const PyramidPosition& position, const std::atomic<bool>* cancel = nullptr);
+
+        private:
+            using Entry = std::pair<TileKey, std::shared_ptr<const FrameBuffer>>;
+
+            mutable std::mutex mutex;
+            std::list<Entry> lru;  // most recently used first
+            std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> index;
+            std::size_t budget;
+            std::size_t bytes;
+            Stats counters;
+            std::shared_ptr<TileStore> store;
+
+            void evict();
+    };
+
+}  // namespace omp
@@ -0,0 +1,261 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Persistent pool of pinned worker threads that render square tiles
+             Each worker owns a deque of tiles and steals from the others when it runs dry
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "tile_scheduler.h"
+#include "trace.h"
+
+namespace omp {
+
+namespace {
+
+// identifies the pool and deque of the worker running on this thread, used by spawn
+thread_local const TileScheduler* currentScheduler = nullptr;
+thread_local unsigned currentWorker = 0;
+
+// CPUs the process may run on (taskset, cpuset cgroups), in ascending order, empty where affinity is unknown
+std::vector<int> allowedCpus()
+{
+	std::vector<int> cpus;
+#ifdef __linux__
+	// the process id names the main thread, so a pool built from a pinned worker still sees the whole mask
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+	if (sched_getaffinity(getpid(), sizeof(mask), &mask) == 0)
+	{
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		{
+			if (CPU_ISSET(cpu, &mask))
+			{
+				cpus.push_back(cpu);
+			}
+		}
+	}
+#endif
+	return cpus;
+}
+
+}  // namespace
+
+TileScheduler::TileScheduler(unsigned threads, bool pin) : stopping(false), queued(0)
+{
+	const std::vector<int> cpus = allowedCpus();
+	if (threads == 0)
+	{
+		threads = cpus.empty() ? std::max(1u, std::thread::hardware_concurrency()) : unsigned(cpus.size());
+	}
+
+	for (unsigned i = 0; i < threads; ++i)
+	{
+		workers.emplace_back(new Worker());
+	}
+	for (unsigned i = 0; i < threads; ++i)
+	{
+		workers[i]->thread = std::thread(&TileScheduler::workerLoop, this, i);
+#ifdef __linux__
+		// worker i goes to the i-th allowed CPU, a failed pin leaves the worker to the OS scheduler
+		if (pin && !cpus.empty())
+		{
+			const int cpu = cpus[i % cpus.size()];
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(cpu, &set);
+			const int error = pthread_setaffinity_np(workers[i]->thread.native_handle(), sizeof(set), &set);
+			if (error != 0)
+			{
+				std::cerr << "tile scheduler: cannot pin worker " << i << " to CPU " << cpu << ": " << std::strerror(error) << std::endl;
+			}
+		}
+#else
+		(void)pin;
+#endif
+	}
+}
+
+TileScheduler::~TileScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& worker : workers)
+	{
+		worker->thread.join();
+	}
+}
+
+/**
+ * Distributes the tiles over the worker deques and waits for them to be rendered.
+ * Tiles are sorted by estimated cost and dealt round-robin, so every worker starts on
+ * the most expensive tiles and the cheap ones are left to balance the tail of the frame.
+ * Every tile carries its batch, so runs from other threads (a frame being colored while
+ * the next one is iterated) mix into the same deques instead of waiting for each other.
+ *
+ * @param tiles work items for this run
+ * @param work called once per tile from a worker thread
+ * @param cancel optional flag, queued tiles are skipped once it is set
+ * 
+ */
+bool TileScheduler::run(std::vector<Tile> tiles, const std::function<void(const Tile&)>& work_fn, const std::atomic<bool>* cancel_flag)
+{
+	if (tiles.empty())
+	{
+		return true;
+	}
+
+	std::stable_sort(tiles.begin(), tiles.end(), [](const Tile& a, const Tile& b) { return a.cost > b.cost; });
+
+	Batch batch{&work_fn, cancel_flag, {tiles.size()}};
+	std::unique_lock<std::mutex> lock(mutex);
+	for (std::size_t i = 0; i < tiles.size(); ++i)
+	{
+		this->push(unsigned(i % workers.size()), Task{tiles[i], &batch}, false);
+	}
+	wake.notify_all();
+
+	finished.wait(lock, [&batch] { return batch.remaining.load() == 0; });
+	return !(cancel_flag != nullptr && cancel_flag->load());
+}
+
+/**
+ * Adds a tile to the run whose tile is being worked on. Only valid inside the work callback of run().
+ *
+ * @param tile rectangle handed to the work callback like the tiles passed to run()
+ * 
+ */
+void TileScheduler::spawn(const Tile& tile)
+{
+	const unsigned index = (currentScheduler == this) ? currentWorker : 0;
+	Batch* batch = workers[index]->current;
+	batch->remaining.fetch_add(1);
+	this->push(index, Task{tile, batch}, true);
+	{
+		std::lock_guard<std::mutex> lock(mutex);  // pairs with the wait in workerLoop so the wakeup is not lost
+	}
+	wake.notify_one();
+}
+
+void TileScheduler::workerLoop(unsigned index)
+{
+	currentScheduler = this;
+	currentWorker = index;
+#if FRACTAL_TRACING
+	trace::setThreadName("worker " + std::to_string(index));
+#endif
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+			if (stopping)
+			{
+				return;
+			}
+		}
+
+		Task task;
+		while (this->pop(index, task) || this->steal(index, task))
+		{
+			Batch& batch = *task.batch;
+			if (batch.cancel == nullptr || !batch.cancel->load(std::memory_order_relaxed))
+			{
+				workers[index]->current = &batch;
+				(*batch.work)(task.tile);
+				workers[index]->current = nullptr;
+			}
+
+			// run() may return and destroy the batch as soon as remaining reaches 0
+			if (batch.remaining.fetch_sub(1) == 1)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				finished.notify_all();
+			}
+		}
+	}
+}
+
+void TileScheduler::push(unsigned index, const Task& task, bool front)
+{
+	Worker& worker = *workers[index];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (front)
+	{
+		worker.tasks.push_front(task);
+	}
+	else
+	{
+		worker.tasks.push_back(task);
+	}
+	queued.fetch_add(1);
+}
+
+// Takes the most expensive tile left in the worker's own deque
+bool TileScheduler::pop(unsigned index, Task& task)
+{
+	Worker& worker = *workers[index];
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.tasks.empty())
+	{
+		return false;
+	}
+	task = worker.tasks.front();
+	worker.tasks.pop_front();
+	queued.fetch_sub(1);
+	return true;
+}
+
+// Takes the most expensive tile left in another worker's deque, visiting neighbours first
+bool TileScheduler::steal(unsigned index, Task& task)
+{
+	for (std::size_t offset = 1; offset < workers.size(); ++offset)
+	{
+		Worker& victim = *workers[(index + offset) % workers.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			queued.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<Tile> TileScheduler::makeTiles(int width, int height, int tileSize)
+{
+	std::vector<Tile> tiles;
+	tileSize = std::max(tileSize, 1);
+	for (int y = 0; y < height; y += tileSize)
+	{
+		for (int x = 0; x < width; x += tileSize)
+		{
+			tiles.push_back({x, y, std::min(tileSize, width - x), std::min(tileSize, height - y), 0});
+		}
+	}
+	return tiles;
+}
+
+TileScheduler& TileScheduler::instance()
+{
+	static TileScheduler scheduler;
+	return scheduler;
+}
+
+}  // namespace omp
@@ -0,0 +1,99 @@
+/* 
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+ 
+Description: Persistent pool of pinned worker threads that render square tiles
+             Each worker owns a deque of tiles and steals from the others when it runs dry
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace omp {
+
+    // Rectangle of pixels handed to a worker as one unit of work
+    struct Tile
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+        uint64_t cost;  // estimated cost, higher cost tiles are scheduled first
+    };
+
+    class TileScheduler
+    {
+        public:
+            static constexpr int defaultTileSize = 32;
+
+            // Starts threads workers (0 = one per CPU in the process affinity mask), optionally pinning each to one of those CPUs
+            explicit TileScheduler(unsigned threads = 0, bool pin = true);
+            ~TileScheduler();
+            TileScheduler(const TileScheduler&) = delete;
+            TileScheduler& operator=(const TileScheduler&) = delete;
+
+            // Runs work on every tile and blocks until all are finished, most expensive tiles first
+            // Tiles still queued when cancel becomes true are skipped. Runs from different threads share the workers
+            // and proceed together, but a work callback must not start a run of its own (use spawn)
+            // Returns: false if the run was cancelled
+            bool run(std::vector<Tile> tiles, const std::function<void(const Tile&)>& work, const std::atomic<bool>* cancel = nullptr);
+
+            // Queues another tile from inside a work callback, run() does not return before it is finished
+            // The tile goes to the front of the calling worker's deque, idle workers may steal it
+            void spawn(const Tile& tile);
+
+            unsigned threadCount() const { return unsigned(workers.size()); }
+
+            // Splits a width x height frame into tileSize x tileSize tiles (smaller at the right and bottom edges)
+            static std::vector<Tile> makeTiles(int width, int height, int tileSize = defaultTileSize);
+
+            // Process wide pool shared by the renderers
+            static TileScheduler& instance();
+
+        private:
+            // Tiles of one call to run()
+            struct Batch
+            {
+                const std::function<void(const Tile&)>* work;
+                const std::atomic<bool>* cancel;
+                std::atomic<std::size_t> remaining;  // tiles queued or in progress
+            };
+
+            struct Task
+            {
+                Tile tile;
+                Batch* batch;
+            };
+
+            struct Worker
+            {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+                std::thread thread;
+                Batch* current = nullptr;  // batch of the tile being worked on, only touched by the worker's thread
+            };
+
+            std::vector<std::unique_ptr<Worker>> workers;
+            std::mutex mutex;
+            std::condition_variable wake;      // signals workers that tiles were queued
+            std::condition_variable finished;  // signals run() that the last tile of a batch completed
+            bool stopping;
+            std::atomic<std::size_t> queued;   // tiles sitting in a deque
+
+            void workerLoop(unsigned index);
+            void push(unsigned index, const Task& task, bool front);
+            bool pop(unsigned index, Task& task);
+            bool steal(unsigned index, Task& task);
+    };
+
+}  // namespace omp
@@ -0,0 +1,571 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Persistent tile pyramid file, read through mmap and appended to by batch renderers
+             Layout: a fixed header, a chain of index blocks and run-length encoded tiles, all append-only
+             so a viewer can open the file while another process is still writing it
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tile_store.h"
+
+namespace omp {
+
+namespace {
+
+using namespace pyramid_file;
+
+constexpr std::size_t entriesOffset = offsetof(IndexBlock, entries);
+constexpr int precomputeBatch = 64;  // tiles calculated per worker pool run, bounds the memory of a precompute
+
+uint8_t interiorBits(InteriorChecks interior)
+{
+	return uint8_t((interior.cardioid ? 1 : 0) | (interior.periodicity ? 2 : 0));
+}
+
+bool writeAll(int fd, const void* data, std::size_t size, uint64_t offset)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	while (size > 0)
+	{
+		const ssize_t written = ::pwrite(fd, bytes, size, off_t(offset));
+		if (written <= 0)
+		{
+			return false;
+		}
+		bytes += written;
+		size -= std::size_t(written);
+		offset += uint64_t(written);
+	}
+	return true;
+}
+
+bool readAll(int fd, void* data, std::size_t size, uint64_t offset)
+{
+	uint8_t* bytes = static_cast<uint8_t*>(data);
+	while (size > 0)
+	{
+		const ssize_t read = ::pread(fd, bytes, size, off_t(offset));
+		if (read <= 0)
+		{
+			return false;
+		}
+		bytes += read;
+		size -= std::size_t(read);
+		offset += uint64_t(read);
+	}
+	return true;
+}
+
+bool validHeader(const Header& header)
+{
+	return std::memcmp(header.magic, magic, sizeof(magic)) == 0 && header.version == version && header.tileSize == uint32_t(pyramidTileSize)
+		&& header.firstBlock >= sizeof(Header);
+}
+
+TileKey formatKey(const Header& header)
+{
+	TileKey key;
+	key.fractal = Fractal(header.fractal);
+	key.maxIterations = int(header.maxIterations);
+	key.interior.cardioid = (header.interior & 1) != 0;
+	key.interior.periodicity = (header.interior & 2) != 0;
+	return key;
+}
+
+bool sameFormat(const TileKey& a, const TileKey& b)
+{
+	return a.fractal == b.fractal && a.maxIterations == b.maxIterations && a.interior.cardioid == b.interior.cardioid && a.interior.periodicity == b.interior.periodicity;
+}
+
+TileKey entryKey(const TileKey& format, const Entry& entry)
+{
+	TileKey key = format;
+	key.level = entry.level;
+	key.tx = entry.tx;
+	key.ty = entry.ty;
+	return key;
+}
+
+int64_t floorTile(double coordinate, double size)
+{
+	return int64_t(std::floor(coordinate / size));
+}
+
+}  // namespace
+
+/**
+ * PackBits style encoding over the tile in row-major order. A control word with the high bit
+ * set is followed by one value repeated (control & 0x7FFF) + 1 times, otherwise it is followed
+ * by control + 1 literal values.
+ *
+ * @param tile pyramidTileSize square iteration buffer
+ * @param encoded receives the control and value words
+ *
+ */
+void encodeTile(const FrameBuffer& tile, std::vector<uint16_t>& encoded)
+{
+	constexpr std::size_t maxRun = 0x8000;
+	const std::size_t width = std::size_t(tile.width());
+	const std::size_t count = width * tile.height();
+	auto value = [&](std::size_t k) { return tile.row(int(k / width))[k % width]; };
+	auto runLength = [&](std::size_t k)
+	{
+		std::size_t length = 1;
+		while (k + length < count && length < maxRun && value(k + length) == value(k))
+		{
+			++length;
+		}
+		return length;
+	};
+
+	encoded.clear();
+	std::size_t k = 0;
+	while (k < count)
+	{
+		const std::size_t run = runLength(k);
+		if (run >= 3)
+		{
+			encoded.push_back(uint16_t(0x8000 | (run - 1)));
+			encoded.push_back(value(k));
+			k += run;
+			continue;
+		}
+
+		// literals end where a run worth encoding starts
+		std::size_t end = k + run;
+		while (end < count && end - k < maxRun && runLength(end) < 3)
+		{
+			++end;
+		}
+		end = std::min(end, k + maxRun);
+		encoded.push_back(uint16_t(end - k - 1));
+		for (; k < end; ++k)
+		{
+			encoded.push_back(value(k));
+		}
+	}
+}
+
+bool decodeTile(const uint16_t* encoded, std::size_t count, FrameBuffer& tile)
+{
+	const std::size_t width = std::size_t(tile.width());
+	const std::size_t total = width * tile.height();
+	std::size_t k = 0;
+	std::size_t position = 0;
+	while (position < count && k < total)
+	{
+		const uint16_t control = encoded[position++];
+		const bool run = (control & 0x8000) != 0;
+		const std::size_t length = std::size_t(control & 0x7FFF) + 1;
+		if (k + length > total || position + (run ? 1 : length) > count)
+		{
+			return false;
+		}
+		for (std::size_t n = 0; n < length; ++n, ++k)
+		{
+			tile.row(int(k / width))[k % width] = run ? encoded[position] : encoded[position + n];
+		}
+		position += run ? 1 : length;
+	}
+	return k == total;
+}
+
+TileStore::~TileStore()
+{
+	this->close();
+}
+
+/**
+ * Maps a pyramid file and indexes the tiles published so far. Only the header and the index
+ * blocks are touched, tile data is paged in when a tile is loaded.
+ *
+ * @param path pyramid file written by TileStoreWriter
+ *
+ */
+bool TileStore::open(const std::string& path)
+{
+	this->close();
+	std::lock_guard<std::mutex> lock(mutex);
+	fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0 || !this->remap() || mapped < sizeof(Header) || !validHeader(*reinterpret_cast<const Header*>(base)))
+	{
+		if (base != nullptr)
+		{
+			::munmap(const_cast<uint8_t*>(base), mapped);
+			base = nullptr;
+			mapped = 0;
+		}
+		if (fd >= 0)
+		{
+			::close(fd);
+			fd = -1;
+		}
+		return false;
+	}
+
+	const Header& header = *reinterpret_cast<const Header*>(base);
+	format = formatKey(header);
+	block = header.firstBlock;
+	consumed = 0;
+	this->scan();
+	return true;
+}
+
+void TileStore::close()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (base != nullptr)
+	{
+		::munmap(const_cast<uint8_t*>(base), mapped);
+	}
+	if (fd >= 0)
+	{
+		::close(fd);
+	}
+	fd = -1;
+	base = nullptr;
+	mapped = 0;
+	index.clear();
+}
+
+void TileStore::refresh()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (base != nullptr)
+	{
+		this->scan();
+	}
+}
+
+bool TileStore::contains(const TileKey& key)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return index.count(key) != 0;
+}
+
+std::size_t TileStore::tileCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return index.size();
+}
+
+/**
+ * Decodes a tile straight out of the mapping, only the pages of this tile are read.
+ *
+ * @param key tile to load
+ * @param tile pyramidTileSize square buffer that receives the iterations
+ *
+ */
+bool TileStore::load(const TileKey& key, FrameBuffer& tile)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto entry = index.find(key);
+	if (entry == index.end() || tile.width() != pyramidTileSize || tile.height() != pyramidTileSize)
+	{
+		return false;
+	}
+	const uint16_t* encoded = reinterpret_cast<const uint16_t*>(base + entry->second.offset);
+	return decodeTile(encoded, entry->second.bytes / sizeof(uint16_t), tile);
+}
+
+// Maps the whole file again if it grew, the caller holds the mutex
+bool TileStore::remap()
+{
+	struct stat info;
+	if (::fstat(fd, &info) != 0)
+	{
+		return false;
+	}
+	const std::size_t size = std::size_t(info.st_size);
+	if (size == mapped)
+	{
+		return base != nullptr;
+	}
+
+	void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+	if (base != nullptr)
+	{
+		::munmap(const_cast<uint8_t*>(base), mapped);
+	}
+	base = static_cast<const uint8_t*>(mapping);
+	mapped = size;
+	return true;
+}
+
+/**
+ * Indexes entries published since the last scan. The writer stores an entry before it
+ * raises the block's count, so every counted entry is complete; an entry whose tile lies
+ * past the mapping is picked up again after a remap.
+ */
+void TileStore::scan()
+{
+	while (true)
+	{
+		if (block + sizeof(IndexBlock) > mapped && (!this->remap() || block + sizeof(IndexBlock) > mapped))
+		{
+			return;
+		}
+
+		const IndexBlock* current = reinterpret_cast<const IndexBlock*>(base + block);
+		const uint32_t published = std::min(__atomic_load_n(&current->count, __ATOMIC_ACQUIRE), blockEntries);
+		for (; consumed < published; ++consumed)
+		{
+			const Entry entry = current->entries[consumed];
+			if (entry.offset + entry.bytes > mapped)
+			{
+				if (!this->remap() || entry.offset + entry.bytes > mapped)
+				{
+					return;
+				}
+				current = reinterpret_cast<const IndexBlock*>(base + block);  // the old mapping is gone
+			}
+			index[entryKey(format, entry)] = entry;
+		}
+
+		const uint64_t next = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE);
+		if (consumed < blockEntries || next == 0)
+		{
+			return;
+		}
+		block = next;
+		consumed = 0;
+	}
+}
+
+TileStoreWriter::~TileStoreWriter()
+{
+	this->close();
+}
+
+/**
+ * Opens a pyramid file for appending, creating it if needed. The first index block is
+ * written before the header, so a reader never sees a valid header without its index.
+ *
+ * @param path pyramid file
+ * @param maxIterations iteration limit of every tile in the file
+ * @param interior interior checks of every tile in the file
+ *
+ */
+bool TileStoreWriter::open(const std::string& path, int maxIterations, InteriorChecks interior)
+{
+	this->close();
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0 || ::flock(fd, LOCK_EX | LOCK_NB) != 0)
+	{
+		this->close();
+		return false;
+	}
+
+	format = TileKey();
+	format.maxIterations = maxIterations;
+	format.interior = interior;
+
+	struct stat info;
+	if (::fstat(fd, &info) != 0)
+	{
+		this->close();
+		return false;
+	}
+
+	Header header;
+	if (info.st_size == 0)
+	{
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = version;
+		header.tileSize = uint32_t(pyramidTileSize);
+		header.maxIterations = uint32_t(maxIterations);
+		header.fractal = uint8_t(format.fractal);
+		header.interior = interiorBits(interior);
+		header.firstBlock = sizeof(Header);
+
+		std::vector<uint8_t> empty(sizeof(IndexBlock), 0);
+		if (!writeAll(fd, empty.data(), empty.size(), header.firstBlock) || !writeAll(fd, &header, sizeof(header), 0))
+		{
+			this->close();
+			return false;
+		}
+		block = header.firstBlock;
+		count = 0;
+		end = header.firstBlock + sizeof(IndexBlock);
+		return true;
+	}
+
+	if (!readAll(fd, &header, sizeof(header), 0) || !validHeader(header) || !sameFormat(formatKey(header), format))
+	{
+		this->close();
+		return false;
+	}
+
+	// walk the index to find where to continue and which tiles are already there
+	block = header.firstBlock;
+	while (true)
+	{
+		IndexBlock current;
+		if (!readAll(fd, &current, sizeof(current), block))
+		{
+			this->close();
+			return false;
+		}
+		count = std::min(current.count, blockEntries);
+		for (uint32_t k = 0; k < count; ++k)
+		{
+			written.insert(entryKey(format, current.entries[k]));
+		}
+		if (count < blockEntries || current.next == 0)
+		{
+			break;
+		}
+		block = current.next;
+	}
+	end = uint64_t(info.st_size);
+	return true;
+}
+
+void TileStoreWriter::close()
+{
+	if (fd >= 0)
+	{
+		::fdatasync(fd);
+		::close(fd);  // releases the flock
+	}
+	fd = -1;
+	written.clear();
+}
+
+/**
+ * Appends a tile and publishes it. Order matters for concurrent readers: the encoded tile,
+ * then a new index block if the current one is full, then the entry and last the count.
+ *
+ * @param key tile position, must match the file's iteration limit and interior checks
+ * @param tile pyramidTileSize square iteration buffer
+ *
+ */
+bool TileStoreWriter::append(const TileKey& key, const FrameBuffer& tile)
+{
+	if (fd < 0 || !sameFormat(key, format) || tile.width() != pyramidTileSize || tile.height() != pyramidTileSize)
+	{
+		return false;
+	}
+	if (this->contains(key))
+	{
+		return true;
+	}
+
+	std::vector<uint16_t> encoded;
+	encodeTile(tile, encoded);
+
+	Entry entry;
+	entry.tx = key.tx;
+	entry.ty = key.ty;
+	entry.level = key.level;
+	entry.offset = (end + 7) / 8 * 8;  // keeps tiles and blocks aligned in the mapping
+	entry.bytes = uint32_t(encoded.size() * sizeof(uint16_t));
+	if (!writeAll(fd, encoded.data(), entry.bytes, entry.offset))
+	{
+		return false;
+	}
+	end = entry.offset + entry.bytes;
+
+	if (count == blockEntries)
+	{
+		const uint64_t next = (end + 7) / 8 * 8;
+		std::vector<uint8_t> empty(sizeof(IndexBlock), 0);
+		if (!writeAll(fd, empty.data(), empty.size(), next) || !writeAll(fd, &next, sizeof(next), block + offsetof(IndexBlock, next)))
+		{
+			return false;
+		}
+		end = next + sizeof(IndexBlock);
+		block = next;
+		count = 0;
+	}
+
+	const uint32_t published = count + 1;
+	if (!writeAll(fd, &entry, sizeof(entry), block + entriesOffset + uint64_t(count) * sizeof(Entry))
+		|| !writeAll(fd, &published, sizeof(published), block + offsetof(IndexBlock, count)))
+	{
+		return false;
+	}
+	count = published;
+	written.insert(key);
+	return true;
+}
+
+/**
+ * Fills a region of one pyramid level. Tiles are calculated in batches on the worker pool
+ * and appended as each batch finishes, so an interrupted run keeps everything before it.
+ *
+ * @param level pyramid level, tiles span 5 * 2^-level in the complex plane
+ * @param real0 one corner of the region
+ * @param imag0
+ * @param real1 opposite corner of the region
+ * @param imag1
+ * @param options kernel and tile size, the interior checks must match the file
+ *
+ */
+int64_t TileStoreWriter::precompute(int level, double real0, double imag0, double real1, double imag1, const RenderOptions& options)
+{
+	// pixelToReal/pixelToImag: real = 5 * frame_x, imag = -5 * frame_y, tile rows grow with imag
+	const double span = 5.0 * std::ldexp(1.0, -level);
+	const int64_t tx0 = floorTile(std::min(real0, real1), span);
+	const int64_t tx1 = floorTile(std::max(real0, real1), span);
+	const int64_t ty0 = floorTile(std::min(imag0, imag1), span);
+	const int64_t ty1 = floorTile(std::max(imag0, imag1), span);
+
+	std::vector<TileKey> keys;
+	for (int64_t ty = ty0; ty <= ty1; ++ty)
+	{
+		for (int64_t tx = tx0; tx <= tx1; ++tx)
+		{
+			TileKey key = format;
+			key.level = level;
+			key.tx = tx;
+			key.ty = ty;
+			if (!this->contains(key))
+			{
+				keys.push_back(key);
+			}
+		}
+	}
+
+	RenderOptions tileOptions = options;
+	tileOptions.interior = format.interior;
+	int64_t appended = 0;
+	for (std::size_t first = 0; first < keys.size(); first += precomputeBatch)
+	{
+		const std::vector<TileKey> batch(keys.begin() + first, keys.begin() + std::min(keys.size(), first + precomputeBatch));
+		std::vector<std::shared_ptr<FrameBuffer>> tiles;
+		for (std::size_t k = 0; k < batch.size(); ++k)
+		{
+			tiles.push_back(std::make_shared<FrameBuffer>(pyramidTileSize, pyramidTileSize));
+		}
+		renderPyramidTiles(batch, tiles, tileOptions);
+		for (std::size_t k = 0; k < batch.size(); ++k)
+		{
+			if (!this->append(batch[k], *tiles[k]))
+			{
+				return -1;
+			}
+			++appended;
+		}
+	}
+	return appended;
+}
+
+}  // namespace omp
@@ -0,0 +1,143 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Persistent tile pyramid file, read through mmap and appended to by batch renderers
+             Layout: a fixed header, a chain of index blocks and run-length encoded tiles, all append-only
+             so a viewer can open the file while another process is still writing it
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tile_cache.h"
+
+namespace omp {
+
+    // On-disk structures, little endian as written by the host
+    namespace pyramid_file {
+
+        constexpr char magic[8] = {'F', 'R', 'C', 'T', 'P', 'Y', 'R', '1'};
+        constexpr uint32_t version = 1;
+        constexpr uint32_t blockEntries = 1023;  // index entries per block, a block plus its header fits 32 KiB
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t tileSize;        // pyramidTileSize when written
+            uint32_t maxIterations;
+            uint8_t fractal;
+            uint8_t interior;         // bit 0 cardioid, bit 1 periodicity
+            uint16_t reserved;
+            uint64_t firstBlock;      // file offset of the first index block
+            uint64_t reserved2[4];
+        };
+
+        struct Entry
+        {
+            int64_t tx;
+            int64_t ty;
+            uint64_t offset;  // file offset of the encoded tile
+            uint32_t bytes;   // encoded size
+            int32_t level;
+        };
+
+        struct IndexBlock
+        {
+            uint64_t next;   // file offset of the next block, 0 until this one is full
+            uint32_t count;  // published entries, only ever grows
+            uint32_t reserved;
+            Entry entries[blockEntries];
+        };
+
+        static_assert(sizeof(Header) == 64, "header layout is part of the file format");
+        static_assert(sizeof(Entry) == 32, "entry layout is part of the file format");
+        static_assert(sizeof(IndexBlock) == 16 + blockEntries * sizeof(Entry), "index block layout is part of the file format");
+
+    }  // namespace pyramid_file
+
+    // Read-only view of a pyramid file, tiles are decoded straight out of the mapping
+    class TileStore
+    {
+        public:
+            TileStore() = default;
+            ~TileStore();
+            TileStore(const TileStore&) = delete;
+            TileStore& operator=(const TileStore&) = delete;
+
+            // Maps the file, returns false if it is missing or not a pyramid file
+            bool open(const std::string& path);
+            void close();
+            bool isOpen() const { return base != nullptr; }
+
+            // Picks up tiles appended since the last call, remapping the file if it grew
+            void refresh();
+
+            // Returns true if the file holds the tile, keys of another iteration limit or interior checks never match
+            bool contains(const TileKey& key);
+
+            // Decodes a tile into a pyramidTileSize square buffer, returns false if the file does not hold it
+            bool load(const TileKey& key, FrameBuffer& tile);
+
+            std::size_t tileCount();
+
+        private:
+            std::mutex mutex;
+            int fd = -1;
+            const uint8_t* base = nullptr;  // read-only shared mapping of the file
+            std::size_t mapped = 0;
+            uint64_t block = 0;             // index block read last
+            uint32_t consumed = 0;          // entries of that block already indexed
+            std::unordered_map<TileKey, pyramid_file::Entry, TileKeyHash> index;
+            TileKey format;                 // fractal, iteration limit and interior checks of the file
+
+            bool remap();
+            void scan();
+    };
+
+    // Appends tiles to a pyramid file, one writer per file at a time (enforced with flock)
+    class TileStoreWriter
+    {
+        public:
+            TileStoreWriter() = default;
+            ~TileStoreWriter();
+            TileStoreWriter(const TileStoreWriter&) = delete;
+            TileStoreWriter& operator=(const TileStoreWriter&) = delete;
+
+            // Opens or creates the file, an existing file must have the same iteration limit and interior checks
+            bool open(const std::string& path, int maxIterations = MAX_ITERATIONS, InteriorChecks interior = InteriorChecks());
+            void close();
+
+            bool isOpen() const { return fd >= 0; }
+            bool contains(const TileKey& key) const { return written.count(key) != 0; }
+
+            // Encodes and appends one tile, then publishes its index entry
+            bool append(const TileKey& key, const FrameBuffer& tile);
+
+            // Calculates the tiles of a level covering a rectangle of the complex plane and appends those not yet in the file
+            // Returns: number of tiles appended, -1 on a write error
+            int64_t precompute(int level, double real0, double imag0, double real1, double imag1, const RenderOptions& options = RenderOptions());
+
+        private:
+            int fd = -1;
+            uint64_t block = 0;   // current index block
+            uint32_t count = 0;   // entries in the current block
+            uint64_t end = 0;     // file size
+            std::unordered_set<TileKey, TileKeyHash> written;
+            TileKey format;
+    };
+
+    // Run-length encoding of a tile, uniform runs (the interior, far outside) collapse to one value
+    void encodeTile(const FrameBuffer& tile, std::vector<uint16_t>& encoded);
+    bool decodeTile(const uint16_t* encoded, std::size_t count, FrameBuffer& tile);
+
+}  // namespace omp
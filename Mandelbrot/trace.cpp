@@ -0,0 +1,241 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Low-overhead instrumentation of the render hot paths
+             Scoped timers and counters go into per-thread ring buffers, which can be summarized for
+             the stats overlay or dumped as a Chrome trace_event file (chrome://tracing, Perfetto)
+             Building with FRACTAL_TRACING=0 compiles every TRACE_ macro out
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "trace.h"
+
+namespace omp {
+namespace trace {
+
+namespace {
+
+// Ring buffer of one thread, the lock is only contended while the buffer is being read
+struct ThreadBuffer
+{
+	std::mutex mutex;
+	std::vector<Event> events;
+	uint64_t written = 0;  // events ever recorded, the newest is at (written - 1) % ringCapacity
+	std::string name;
+	unsigned id = 0;
+};
+
+// Buffers of every thread that recorded something, kept after the thread exits so its events can still be dumped
+struct Registry
+{
+	std::mutex mutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& registry()
+{
+	static Registry instance;
+	return instance;
+}
+
+ThreadBuffer& localBuffer()
+{
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (buffer == nullptr)
+	{
+		Registry& all = registry();
+		std::lock_guard<std::mutex> lock(all.mutex);
+		all.buffers.emplace_back(new ThreadBuffer());
+		buffer = all.buffers.back().get();
+		buffer->events.resize(ringCapacity);
+		buffer->id = unsigned(all.buffers.size());
+		buffer->name = "thread " + std::to_string(buffer->id);
+	}
+	return *buffer;
+}
+
+// Copies the events of a buffer that are still held, oldest first
+std::vector<Event> snapshot(ThreadBuffer& buffer, std::string& name)
+{
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	name = buffer.name;
+	const uint64_t held = std::min<uint64_t>(buffer.written, ringCapacity);
+	std::vector<Event> events;
+	events.reserve(std::size_t(held));
+	for (uint64_t k = buffer.written - held; k < buffer.written; ++k)
+	{
+		events.push_back(buffer.events[std::size_t(k % ringCapacity)]);
+	}
+	return events;
+}
+
+// Names come from string literals and thread names written by this program, quotes and backslashes are all that needs escaping
+std::string quoted(const std::string& text)
+{
+	std::string result = "\"";
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			result += '\\';
+		}
+		result += c;
+	}
+	return result + "\"";
+}
+
+}  // namespace
+
+uint64_t now()
+{
+	static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void record(const Event& event)
+{
+	ThreadBuffer& buffer = localBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.events[std::size_t(buffer.written % ringCapacity)] = event;
+	++buffer.written;
+}
+
+void setThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = localBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.name = name;
+}
+
+/**
+ * Totals the events every thread recorded since a point in time, for the stats overlay.
+ * Events already overwritten in a ring buffer are missing from the totals.
+ *
+ * @param since trace clock time, e.g. now() at the previous call
+ *
+ */
+Summary summarize(uint64_t since)
+{
+	Summary summary;
+	summary.seconds = (now() - since) * 1e-9;
+
+	Registry& all = registry();
+	std::lock_guard<std::mutex> lock(all.mutex);
+	for (const std::unique_ptr<ThreadBuffer>& buffer : all.buffers)
+	{
+		std::string name;
+		uint64_t latest = 0;
+		for (const Event& event : snapshot(*buffer, name))
+		{
+			if (event.start < since)
+			{
+				continue;
+			}
+			switch (event.type)
+			{
+				case EventType::SCOPE:
+					summary.milliseconds[event.name] += event.duration * 1e-6;
+					++summary.scopes[event.name];
+					break;
+				case EventType::COUNT:
+					summary.counts[event.name] += event.value;
+					summary.perThread[name][event.name] += event.value;
+					break;
+				case EventType::SAMPLE:
+					if (event.start >= latest)
+					{
+						summary.samples[event.name] = event.value;
+						latest = event.start;
+					}
+					break;
+			}
+		}
+	}
+	return summary;
+}
+
+/**
+ * Dumps the ring buffers in the Chrome trace_event format: scopes become complete ("X")
+ * events on their thread's track, counters become running totals and samples plain values
+ * on counter ("C") tracks.
+ *
+ * @param path JSON file to write, load it in chrome://tracing or ui.perfetto.dev
+ *
+ */
+bool writeChromeTrace(const std::string& path)
+{
+	struct Tagged
+	{
+		Event event;
+		unsigned thread;
+	};
+	std::vector<Tagged> events;
+	std::vector<std::pair<unsigned, std::string>> threads;
+	{
+		Registry& all = registry();
+		std::lock_guard<std::mutex> lock(all.mutex);
+		for (const std::unique_ptr<ThreadBuffer>& buffer : all.buffers)
+		{
+			std::string name;
+			for (const Event& event : snapshot(*buffer, name))
+			{
+				events.push_back({event, buffer->id});
+			}
+			threads.emplace_back(buffer->id, name);
+		}
+	}
+	std::sort(events.begin(), events.end(), [](const Tagged& a, const Tagged& b) { return a.event.start < b.event.start; });
+
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+	file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	bool first = true;
+	const auto separator = [&]() -> std::ofstream&
+	{
+		file << (first ? "" : ",\n");
+		first = false;
+		return file;
+	};
+	for (const auto& thread : threads)
+	{
+		separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread.first << ", \"args\": {\"name\": " << quoted(thread.second) << "}}";
+	}
+
+	std::map<std::string, int64_t> totals;
+	for (const Tagged& tagged : events)
+	{
+		const Event& event = tagged.event;
+		const std::string name = quoted(event.name);
+		separator() << "{\"name\": " << name << ", \"pid\": 1, \"tid\": " << tagged.thread << ", \"ts\": " << event.start / 1000.0;
+		switch (event.type)
+		{
+			case EventType::SCOPE:
+				file << ", \"ph\": \"X\", \"dur\": " << event.duration / 1000.0 << "}";
+				break;
+			case EventType::COUNT:
+				totals[event.name] += event.value;
+				file << ", \"ph\": \"C\", \"args\": {" << name << ": " << totals[event.name] << "}}";
+				break;
+			case EventType::SAMPLE:
+				file << ", \"ph\": \"C\", \"args\": {" << name << ": " << event.value << "}}";
+				break;
+		}
+	}
+	file << "\n]}\n";
+	return bool(file);
+}
+
+}  // namespace trace
+}  // namespace omp
@@ -0,0 +1,100 @@
+/*
+Author: Jack Crandell & James Springer
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Low-overhead instrumentation of the render hot paths
+             Scoped timers and counters go into per-thread ring buffers, which can be summarized for
+             the stats overlay or dumped as a Chrome trace_event file (chrome://tracing, Perfetto)
+             Building with FRACTAL_TRACING=0 compiles every TRACE_ macro out
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#ifndef FRACTAL_TRACING
+#define FRACTAL_TRACING 1
+#endif
+
+namespace omp {
+namespace trace {
+
+    enum class EventType : uint8_t
+    {
+        SCOPE,   // time spent in a named scope
+        COUNT,   // increment of a named counter (tiles, iterations, cache hits)
+        SAMPLE   // measured value (latency), the latest one wins
+    };
+
+    struct Event
+    {
+        const char* name;   // string literal, never freed
+        uint64_t start;     // nanoseconds since the first event of the process
+        uint64_t duration;  // nanoseconds, scopes only
+        int64_t value;      // counts and samples
+        EventType type;
+    };
+
+    // Events kept per thread, the oldest are overwritten first
+    constexpr std::size_t ringCapacity = std::size_t(1) << 15;
+
+    // Nanoseconds on the trace clock
+    uint64_t now();
+
+    // Appends an event to the calling thread's ring buffer
+    void record(const Event& event);
+
+    // Names the calling thread in the trace and the overlay
+    void setThreadName(const std::string& name);
+
+    // Records the time between construction and destruction
+    class Scope
+    {
+        public:
+            explicit Scope(const char* name) : name(name), start(now()) {}
+            ~Scope() { record({name, start, now() - start, 0, EventType::SCOPE}); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char* name;
+            uint64_t start;
+    };
+
+    inline void count(const char* name, int64_t increment) { record({name, now(), 0, increment, EventType::COUNT}); }
+    inline void sample(const char* name, int64_t value) { record({name, now(), 0, value, EventType::SAMPLE}); }
+
+    // Events recorded since a point in time, totalled by name
+    struct Summary
+    {
+        double seconds = 0.0;                                             // length of the summarized window
+        std::map<std::string, double> milliseconds;                       // time per scope, summed over threads
+        std::map<std::string, int64_t> scopes;                            // number of times each scope ran
+        std::map<std::string, int64_t> counts;                            // sum of the increments per counter
+        std::map<std::string, int64_t> samples;                           // latest value per sample
+        std::map<std::string, std::map<std::string, int64_t>> perThread;  // counter sums per thread name
+    };
+
+    Summary summarize(uint64_t since);
+
+    // Writes every buffered event as Chrome trace_event JSON, returns false on I/O errors
+    bool writeChromeTrace(const std::string& path);
+
+}  // namespace trace
+}  // namespace omp
+
+#if FRACTAL_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::omp::trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNT(name, increment) ::omp::trace::count(name, increment)
+#define TRACE_SAMPLE(name, value) ::omp::trace::sample(name, value)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_COUNT(name, increment) ((void)sizeof(increment))  // marks totals that only feed a counter as used
+#define TRACE_SAMPLE(name, value) ((void)0)
+#endif
@@ -0,0 +1,145 @@
+/*
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Offscreen framebuffer the shader modes draw into at a fraction (or a multiple) of the
+             window resolution, scaled onto the window afterwards and timed with GL timer queries
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "ScaledTarget.h"
+
+ScaledTarget::ScaledTarget() : framebuffer_id(0), texture_id(0), query_index(0), gpuTimer(false), width(0), height(0), window_x(0), window_y(0), scale(1.0f),
+                               timing(false), latest(0.0)
+{
+    glGenFramebuffers(1, &framebuffer_id);
+    glGenTextures(1, &texture_id);
+
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // a timer without counter bits is a stub, software drivers are then timed on the CPU
+    GLint bits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &bits);
+    gpuTimer = bits > 0;
+    glGenQueries(queryCount, query_ids);
+    std::fill(query_scales, query_scales + queryCount, 1.0f);
+    std::fill(query_pending, query_pending + queryCount, false);
+}
+
+ScaledTarget::~ScaledTarget()
+{
+    glDeleteQueries(queryCount, query_ids);
+    glDeleteFramebuffers(1, &framebuffer_id);
+    glDeleteTextures(1, &texture_id);
+}
+
+// Input: window dimension in pixels and resolution scale
+// Returns: the dimension of the offscreen framebuffer
+int ScaledTarget::scaled(int pixels, float scale)
+{
+    return std::max(1, int(std::lround(pixels * double(scale))));
+}
+
+// Input: window size in pixels and the resolution scale of this frame
+void ScaledTarget::begin(int new_window_x, int new_window_y, float new_scale)
+{
+    window_x = new_window_x;
+    window_y = new_window_y;
+    scale = new_scale;
+    const int frame_width = scaled(window_x, scale);
+    const int frame_height = scaled(window_y, scale);
+    if (frame_width != width || frame_height != height)
+    {
+        resize(frame_width, frame_height);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+    glViewport(0, 0, width, height);
+
+    // a query whose result has not arrived yet is never reused, that frame is just not timed
+    timing = false;
+    if (!gpuTimer)
+    {
+        cpuStart = std::chrono::steady_clock::now();
+        timing = true;
+    }
+    else if (!query_pending[query_index])
+    {
+        glBeginQuery(GL_TIME_ELAPSED, query_ids[query_index]);
+        timing = true;
+    }
+}
+
+void ScaledTarget::end()
+{
+    if (timing && gpuTimer)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        query_scales[query_index] = scale;
+        query_pending[query_index] = true;
+        query_index = (query_index + 1) % queryCount;
+    }
+    else if (timing)
+    {
+        glFinish();  // without a GPU timer the draw only ends once the driver is done with it
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cpuStart).count();
+        latest = milliseconds / (double(scale) * scale);
+    }
+    timing = false;
+
+    // the filtered blit averages supersampled frames down and interpolates reduced ones up
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_id);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, window_x, window_y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, window_x, window_y);
+}
+
+// Returns: estimated milliseconds of a full resolution frame, the cost is taken to grow with the pixel count
+double ScaledTarget::fullFrameMilliseconds()
+{
+    // oldest query first, so the newest finished one ends up in latest
+    for (int k = 0; k < queryCount; ++k)
+    {
+        const int index = (query_index + k) % queryCount;
+        if (!query_pending[index])
+        {
+            continue;
+        }
+
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query_ids[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE)
+        {
+            continue;
+        }
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query_ids[index], GL_QUERY_RESULT, &nanoseconds);
+        query_pending[index] = false;
+        latest = nanoseconds * 1e-6 / (double(query_scales[index]) * query_scales[index]);
+    }
+    return latest;
+}
+
+// Input: offscreen framebuffer size in pixels
+void ScaledTarget::resize(int new_width, int new_height)
+{
+    width = new_width;
+    height = new_height;
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_id, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,63 @@
+/*
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Offscreen framebuffer the shader modes draw into at a fraction (or a multiple) of the
+             window resolution, scaled onto the window afterwards and timed with GL timer queries
+*/
+
+#pragma once
+
+#include <chrono>
+
+#include <GL/glew.h>  // includes typedefs for OpenGL
+
+class ScaledTarget
+{
+    public:
+        // -methods- //
+
+        // Requires a current OpenGL context, framebuffer storage is allocated on first begin
+        ScaledTarget();
+        ~ScaledTarget();
+        ScaledTarget(const ScaledTarget&) = delete;
+        ScaledTarget& operator=(const ScaledTarget&) = delete;
+
+        // Returns: pixels of a window dimension at the given scale, at least 1
+        static int scaled(int pixels, float scale);
+
+        // Redirects drawing into the offscreen framebuffer, sized scale times the window, and starts timing the frame
+        void begin(int window_x, int window_y, float scale);
+
+        // Stops timing and scales the offscreen frame onto the window with bilinear filtering
+        void end();
+
+        // Returns: milliseconds a full resolution frame would take, estimated from the newest finished measurement, 0 until there is one
+        double fullFrameMilliseconds();
+
+    private:
+        // -members- //
+        static constexpr int queryCount = 4;  // frames in flight that can be timed, results arrive a few frames late
+
+        GLuint framebuffer_id;
+        GLuint texture_id;
+        GLuint query_ids[queryCount];
+        float query_scales[queryCount];  // scale of the frame each query timed
+        bool query_pending[queryCount];
+        int query_index;  // query used by the next frame
+        bool gpuTimer;    // timer queries are supported, otherwise frames are timed on the CPU after glFinish
+        std::chrono::steady_clock::time_point cpuStart;
+        int width;  // offscreen framebuffer size
+        int height;
+        int window_x;
+        int window_y;
+        float scale;
+        bool timing;  // the frame being drawn has a query running
+        double latest;  // newest full-frame estimate in milliseconds
+
+        // -methods- //
+
+        // Reallocates the offscreen texture when its size changes
+        void resize(int new_width, int new_height);
+};
@@ -12,9 +12,9 @@ Description: Wrapper class for OpenGL shaders
 
 #include "Shader.h"
 
-Shader::Shader(unsigned int gl_program_id) : program_id(gl_program_id), shaderType(ShaderType::NONE), valid(false) {}
+Shader::Shader(unsigned int gl_program_id) : program_id(gl_program_id), shaderType(ShaderType::NONE), shader_id(0), valid(false) {}
 
-Shader::Shader(const std::string file_path, unsigned int gl_program_id, ShaderType gl_shaderType) : program_id(gl_program_id), shaderType(gl_shaderType), valid(false)
+Shader::Shader(const std::string file_path, unsigned int gl_program_id, ShaderType gl_shaderType) : program_id(gl_program_id), shaderType(gl_shaderType), shader_id(0), valid(false)
 {
     const std::string shaderCode = getShaderFromFile(file_path);
     if (!shaderCode.empty())
@@ -29,8 +29,11 @@ Shader::Shader(const std::string file_path, unsigned int gl_program_id, ShaderTy
 
 Shader::~Shader()
 {
-    glDetachShader(program_id, shader_id);
-    glDeleteShader(shader_id);
+    if (shader_id != 0)
+    {
+        glDetachShader(program_id, shader_id);
+        glDeleteShader(shader_id);
+    }
 }
 
 void Shader::init(const std::string file_path, ShaderType gl_shaderType)
@@ -0,0 +1,202 @@
+/*
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Registry of linked shader programs, one per fractal mode
+             Programs are built once at startup with their uniform locations cached, and their
+             binaries are saved next to the shader sources so later startups skip compiling
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderCache.h"
+
+namespace {
+
+// Input: file path
+// Returns: contents of the file or empty string if unable to read from it
+std::string readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return file ? contents.str() : std::string();
+}
+
+// 64-bit FNV-1a, enough to tell source and driver versions apart
+uint64_t hashText(uint64_t hash, const std::string& text)
+{
+    for (unsigned char c : text)
+    {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Input: one of the GL_VENDOR, GL_RENDERER, GL_VERSION strings
+// Returns: the string or empty string if the driver has none
+std::string glString(GLenum name)
+{
+    const GLubyte* text = glGetString(name);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+}  // namespace
+
+ShaderCache::ShaderCache(const std::string& binary_dir) : binary_dir(binary_dir), loaded(0), binaries(false)
+{
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    binaries = formats > 0;
+}
+
+ShaderCache::~ShaderCache()
+{
+    for (auto& program : programs)
+    {
+        glDeleteProgram(program.second->id);
+    }
+}
+
+// Input: program name, vertex and fragment shader paths
+// Returns: the linked program or nullptr if it failed to compile or link
+const ShaderProgram* ShaderCache::load(const std::string& name, const std::string& vertex_path, const std::string& fragment_path)
+{
+    auto cached = programs.find(name);
+    if (cached != programs.end())
+    {
+        return cached->second.get();
+    }
+
+    std::unique_ptr<ShaderProgram> program(new ShaderProgram());
+    program->id = glCreateProgram();
+    const std::string path = binaries ? this->binaryPath(name, vertex_path, fragment_path) : "";
+    if (!path.empty() && this->loadBinary(program->id, path))
+    {
+        ++loaded;
+    }
+    else
+    {
+        bool linked = false;
+        {
+            // the shaders are detached and deleted at the end of this block, the linked program keeps the executable
+            Shader vertexShader(vertex_path, program->id, ShaderType::Vertex);
+            Shader fragmentShader(fragment_path, program->id, ShaderType::Fragment);
+            if (vertexShader.isValid() && fragmentShader.isValid())
+            {
+                glProgramParameteri(program->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                linked = Shader::linkShaders(program->id);
+            }
+        }
+        if (!linked)
+        {
+            glDeleteProgram(program->id);
+            return nullptr;
+        }
+        if (!path.empty())
+        {
+            this->saveBinary(program->id, path);
+        }
+    }
+
+    findUniforms(*program);
+    return (programs[name] = std::move(program)).get();
+}
+
+// Input: program name, vertex and fragment shader paths
+// Returns: binary_dir/name-<hash of the sources and driver>.bin, a new driver or edited shader gets a new file
+std::string ShaderCache::binaryPath(const std::string& name, const std::string& vertex_path, const std::string& fragment_path) const
+{
+    const std::string vertex = readFile(vertex_path);
+    const std::string fragment = readFile(fragment_path);
+    if (vertex.empty() || fragment.empty())
+    {
+        return "";
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const std::string& part : {vertex, fragment, glString(GL_VENDOR), glString(GL_RENDERER), glString(GL_VERSION)})
+    {
+        hash = hashText(hash, part);
+        hash = hashText(hash, std::string(1, '\0'));  // keeps "ab" + "c" apart from "a" + "bc"
+    }
+
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+    return binary_dir + "/" + name + "-" + key + ".bin";
+}
+
+// Input: program to restore and path of its saved binary (binary format followed by the binary)
+// Returns: true if the binary was read and the driver linked it
+bool ShaderCache::loadBinary(GLuint program_id, const std::string& path) const
+{
+    const std::string contents = readFile(path);
+    GLenum format;
+    if (contents.size() <= sizeof(format))
+    {
+        return false;
+    }
+
+    std::copy(contents.data(), contents.data() + sizeof(format), reinterpret_cast<char*>(&format));
+    glProgramBinary(program_id, format, contents.data() + sizeof(format), GLsizei(contents.size() - sizeof(format)));
+
+    // a driver update may reject a binary with an unchanged version string, the caller then compiles
+    int success;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+    return success != GL_FALSE;
+}
+
+// Input: linked program and path to save its binary to
+void ShaderCache::saveBinary(GLuint program_id, const std::string& path) const
+{
+    GLint length = 0;
+    glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program_id, length, &length, &format, binary.data());
+
+    // written under a temporary name so an interrupted write never leaves a truncated binary behind
+    const std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(binary.data(), length);
+    file.close();
+    if (!file || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        std::cerr << "Failed to save shader binary: " << path << std::endl;
+    }
+}
+
+// Input: linked program, its uniform map is filled in
+void ShaderCache::findUniforms(ShaderProgram& program)
+{
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(program.id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program.id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<GLchar> name(std::max(maxLength, 1));
+    for (GLint index = 0; index < count; ++index)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program.id, GLuint(index), GLsizei(name.size()), &length, &size, &type, name.data());
+        const std::string uniform(name.data(), length);
+        program.uniforms[uniform] = glGetUniformLocation(program.id, uniform.c_str());
+    }
+}
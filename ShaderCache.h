@@ -0,0 +1,67 @@
+/*
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Registry of linked shader programs, one per fractal mode
+             Programs are built once at startup with their uniform locations cached, and their
+             binaries are saved next to the shader sources so later startups skip compiling
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <GL/glew.h>  // includes typedefs for OpenGL
+
+struct ShaderProgram
+{
+    GLuint id = 0;
+    std::unordered_map<std::string, GLint> uniforms;  // active uniforms, looked up once after linking
+
+    // Returns: location of the uniform or -1 if the program has none, glUniform* ignores -1
+    GLint uniform(const std::string& name) const
+    {
+        auto location = uniforms.find(name);
+        return (location == uniforms.end()) ? -1 : location->second;
+    }
+};
+
+class ShaderCache
+{
+    public:
+        // -methods- //
+
+        // Requires a current OpenGL context, binaries are read from and written to binary_dir
+        explicit ShaderCache(const std::string& binary_dir);
+        ~ShaderCache();
+        ShaderCache(const ShaderCache&) = delete;
+        ShaderCache& operator=(const ShaderCache&) = delete;
+
+        // Links the program for a vertex/fragment pair, from the binary cache if it holds one for these sources and driver
+        // Returns: the program or nullptr if it failed to compile or link, the cache keeps ownership
+        const ShaderProgram* load(const std::string& name, const std::string& vertex_path, const std::string& fragment_path);
+
+        int binariesLoaded() const { return loaded; }
+
+    private:
+        // -members- //
+        const std::string binary_dir;
+        std::unordered_map<std::string, std::unique_ptr<ShaderProgram>> programs;
+        int loaded;  // programs restored from a saved binary
+        bool binaries;  // the driver supports at least one program binary format
+
+        // -methods- //
+
+        // Returns: path of the binary for these sources on this driver, empty if the sources cannot be read
+        std::string binaryPath(const std::string& name, const std::string& vertex_path, const std::string& fragment_path) const;
+
+        // Returns: true if the saved binary was accepted by the driver
+        bool loadBinary(GLuint program_id, const std::string& path) const;
+        void saveBinary(GLuint program_id, const std::string& path) const;
+
+        // Caches the location of every active uniform
+        static void findUniforms(ShaderProgram& program);
+};
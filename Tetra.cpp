@@ -2,15 +2,20 @@
 /* 
 Author: Jackson Crandell
 Class: ECE 4122
-Last Date Modified: 12/07/21 
+Last Date Modified: 10/17/26 
  
 Description: Renders Sierpinski Tetrahedron in OpenGL
+             Each subdivision level is one instanced draw of the base tetrahedron, the leaf
+             offsets are built once per level and kept on the GPU
 */
 
+#include "ShaderCache.h"  // includes GL/glew.h, which has to come before GL/glut.h
 #include <GL/glut.h>
 #include <cstdlib>
 #include <ctime>
+#include <iostream>
 #include <stdio.h>
+#include <vector>
 
 // Funcation prototypes
 void display();
@@ -29,99 +34,90 @@ int iterations = 5;
 double zoom = 0;
 int shading = GL_SMOOTH;
 
+const int MAX_LEVEL = 10;
+ShaderCache *shaderCache = nullptr;
+const ShaderProgram *tetraProgram = nullptr;
+GLuint tetraVAO = 0;
+std::vector<GLuint> levelBuffers(MAX_LEVEL + 1, 0);  // instance offsets per subdivision level, 0 until first drawn
+
 /**
- * Creates a tetrahedron by drawing four triangular faces.
- * 
+ * Fills the base tetrahedron: twelve vertices, position then color, three per face.
+ * Every leaf of the subdivision is this mesh scaled by 2^-level and moved by its offset.
  * 
- * @param *a sets vertex
- * @param *b sets vertex
- * @param *c sets vertex
- * @param *d sets vertex
+ * @param vertices receives 12 * 6 floats
  * 
  */
-void drawTetra(GLfloat *a, GLfloat *b, GLfloat *c, GLfloat *d) {
-	glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);	
-	glShadeModel(shading);
-	
-	glBegin(GL_TRIANGLES);
-		glColor3f(1,0,0);
-		glVertex3fv(a);
-		glColor3f(0,1,0);
-		glVertex3fv(b);
-		glColor3f(0,0,1);
-		glVertex3fv(c);
-	glEnd();
-
-	glBegin(GL_TRIANGLES);
-		glColor3f(0,0,1);
-		glVertex3fv(a);
-		glColor3f(0,1,0);
-		glVertex3fv(b);
-		glColor3f(1,0,0);
-		glVertex3fv(d);
-	glEnd();
-
-	glBegin(GL_TRIANGLES);
-		glColor3f(1,0,0);
-		glVertex3fv(a);
-		glColor3f(0,0,1);
-		glVertex3fv(c);
-		glColor3f(0,1,0);
-		glVertex3fv(d);
-	glEnd();
-
-	glBegin(GL_TRIANGLES);
-		glColor3f(0,1,0);
-		glVertex3fv(b);
-		glColor3f(1,0,0);
-		glVertex3fv(c);
-		glColor3f(0,0,1);
-		glVertex3fv(d);
-	glEnd();
+void baseTetra(GLfloat vertices[]) {
+	static const int faces[4][3] = {{0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3}};
+	static const GLfloat colors[4][3][3] =  {
+												{{1,0,0}, {0,1,0}, {0,0,1}},
+												{{0,0,1}, {0,1,0}, {1,0,0}},
+												{{1,0,0}, {0,0,1}, {0,1,0}},
+												{{0,1,0}, {1,0,0}, {0,0,1}},
+											};
+	for (int face = 0; face < 4; face++)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			GLfloat *vertex = vertices + (face * 3 + corner) * 6;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				vertex[axis] = Tetra[faces[face][corner]][axis];
+				vertex[3 + axis] = colors[face][corner][axis];
+			}
+		}
+	}
 }
 
 /**
- * Divides triangle lengths to find midpoint to draw next triangle.
+ * Finds where every leaf tetrahedron of a subdivision level sits. A tetrahedron of size s at o
+ * divides into four of size s/2, one in each corner k at o + (s/2) * Tetra[k], the same
+ * midpoints the recursive subdivision of the faces produced.
  * 
- * @param V1 sets (x,y) of vertex
- * @param V2 sets (x,y) of vertex
- * @param V3 sets (x,y) of vertex
- * @param V4 sets (x,y) of vertex
+ * @param level number of subdivisions, 4^level leaves
+ * @param offsets receives 3 floats per leaf
  * 
  */
-void divideTetra(GLfloat V1[],GLfloat V2[],GLfloat V3[],GLfloat V4[],int iterations)
-{
-    GLfloat V12[3],V23[3],V31[3],V14[3],V24[3],V34[3];
-    if(iterations > 0)
-    {
-        V12[0] = (V1[0] + V2[0]) / 2;        
-		V12[1] = (V1[1] + V2[1]) / 2;        
-		V12[2] = (V1[2] + V2[2]) / 2;
-        V23[0] = (V2[0] + V3[0]) / 2;        
-		V23[1] = (V2[1] + V3[1]) / 2;        
-		V23[2] = (V2[2] + V3[2]) / 2;
-        V31[0] = (V3[0] + V1[0]) / 2;        
-		V31[1] = (V3[1] + V1[1]) / 2;        
-		V31[2] = (V3[2] + V1[2]) / 2;
-        V14[0] = (V1[0] + V4[0]) / 2;        
-		V14[1] = (V1[1] + V4[1]) / 2;        
-		V14[2] = (V1[2] + V4[2]) / 2;
-        V24[0] = (V2[0] + V4[0]) / 2;        
-		V24[1] = (V2[1] + V4[1]) / 2;        
-		V24[2] = (V2[2] + V4[2]) / 2;
-        V34[0] = (V3[0] + V4[0]) / 2;        
-		V34[1] = (V3[1] + V4[1]) / 2;        
-		V34[2] = (V3[2] + V4[2]) / 2;
+void leafOffsets(int level, std::vector<GLfloat> &offsets) {
+	offsets.assign(3, 0);
+	std::vector<GLfloat> next;
+	GLfloat size = 1;
+	for (int step = 0; step < level; step++)
+	{
+		size /= 2;
+		next.resize(offsets.size() * 4);
+		for (size_t leaf = 0; leaf < offsets.size() / 3; leaf++)
+		{
+			for (int corner = 0; corner < 4; corner++)
+			{
+				for (int axis = 0; axis < 3; axis++)
+				{
+					next[(leaf * 4 + corner) * 3 + axis] = offsets[leaf * 3 + axis] + size * Tetra[corner][axis];
+				}
+			}
+		}
+		offsets.swap(next);
+	}
+}
 
-        divideTetra(V1,V12,V31,V14,iterations-1);
-        divideTetra(V12,V2,V23,V24,iterations-1);
-        divideTetra(V31,V23,V3,V34,iterations-1);
-        divideTetra(V14,V24,V34,V4,iterations-1);
-    }
-    else 
+/**
+ * Returns the instance buffer of a subdivision level, building it on first use. Levels
+ * stay on the GPU, so '=' and '-' only switch buffers after a level has been seen once.
+ * 
+ * @param level number of subdivisions
+ * 
+ */
+GLuint levelBuffer(int level) {
+	if (levelBuffers[level] == 0)
 	{
-		drawTetra(V1,V2,V3,V4);
+		std::vector<GLfloat> offsets;
+		leafOffsets(level, offsets);
+		glGenBuffers(1, &levelBuffers[level]);
+		glBindBuffer(GL_ARRAY_BUFFER, levelBuffers[level]);
+		glBufferData(GL_ARRAY_BUFFER, offsets.size() * sizeof(GLfloat), offsets.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
+	return levelBuffers[level];
 }
 
 /**
@@ -136,18 +132,18 @@ void divideTetra(GLfloat V1[],GLfloat V2[],GLfloat V3[],GLfloat V4[],int iterati
 void keyboard(unsigned char key, int x, int y) {
 	switch (key) {
 		case '=':
-			if (iterations < 10) 
+			if (iterations < MAX_LEVEL) 
 			{
 				iterations += 1;
 			}
-			display();
+			glutPostRedisplay();
 			break;
 		case '-':
 		if (iterations > 0) 
 			{
 				iterations -= 1;
 			}
-			display();
+			glutPostRedisplay();
 			break;
 		case 'q':
 			exit(0);
@@ -179,6 +175,7 @@ void special(int key, int x, int y) {
 			angley -= 1;
 			break;
 	}
+	glutPostRedisplay();
 }
 
 /**
@@ -218,11 +215,12 @@ void zoomIn() {
 	glLoadIdentity();
 	glOrtho(-1.0 - zoom, 1.0 + zoom, -1.0 - zoom, 1.0 + zoom, -20.0, 20.0);
 	glMatrixMode(GL_MODELVIEW);
-	display();
+	glutPostRedisplay();
 }
 
 /**
- * Displays tetrahedron.
+ * Displays tetrahedron. Only called when input changed the scene, the
+ * input handlers post the redisplay.
  */
 void display() {
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -230,11 +228,25 @@ void display() {
 	glRotatef(angley, 0, 1, 0);
 	glRotatef(anglex, 1, 0.0, 0.0 );
 
-	divideTetra(Tetra[0], Tetra[1], Tetra[2], Tetra[3], iterations);
+	GLfloat projection[16], modelview[16];
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+
+	glUseProgram(tetraProgram->id);
+	glUniformMatrix4fv(tetraProgram->uniform("projection"), 1, GL_FALSE, projection);
+	glUniformMatrix4fv(tetraProgram->uniform("modelview"), 1, GL_FALSE, modelview);
+	glUniform1f(tetraProgram->uniform("scale"), 1.0f / (1 << iterations));
+
+	glBindVertexArray(tetraVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, levelBuffer(iterations));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (void*)0);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 12, 1 << (2 * iterations));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
 
 	glPopMatrix();
     glutSwapBuffers();
-	glutPostRedisplay();
 }
 
 /**
@@ -247,6 +259,40 @@ void init() {
 	glLoadIdentity();
 	glOrtho(-2.0, 2.0, -2.0, 2.0, -20.0, 20.0);
 	glEnable(GL_DEPTH_TEST);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glShadeModel(shading);
+}
+
+/**
+ * Loads the tetrahedron shaders and uploads the base tetrahedron. Attribute 2 is the
+ * per-instance offset, its buffer is picked per level in display().
+ */
+bool initMesh() {
+	shaderCache = new ShaderCache("shaders");  // lives until exit
+	tetraProgram = shaderCache->load("tetra", "shaders/tetra.vert", "shaders/tetra.frag");
+	if (tetraProgram == nullptr)
+	{
+		return false;
+	}
+
+	GLfloat vertices[12 * 6];
+	baseTetra(vertices);
+
+	GLuint VBO;
+	glGenVertexArrays(1, &tetraVAO);
+	glGenBuffers(1, &VBO);
+	glBindVertexArray(tetraVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);  // one offset per tetrahedron
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	return true;
 }
 
 
@@ -257,10 +303,24 @@ int main(int argc, char *argv[]) {
 	glutInitWindowPosition(0, 0);
 	glutCreateWindow("Sierpinski Tetrahedron");
 	glutPositionWindow(100, 100);
+
+	GLenum glewErr = glewInit();
+	if (glewErr != GLEW_OK)
+	{
+		std::cerr << "GLEW initialization failed with error code: " << glewErr << std::endl;
+		std::cout << "Exiting..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
 	glutKeyboardFunc(keyboard);
 	glutSpecialFunc(special);
 	glutMouseFunc(mouse);
 	init();
+	if (!initMesh())
+	{
+		std::cerr << "Shader initialization failed, exiting..." << std::endl;
+		return EXIT_FAILURE;
+	}
 	glutDisplayFunc(display);
 	glutMainLoop();
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+/* 
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26 
+ 
+Description: Streams CPU rendered RGBA frames into an OpenGL texture through
+             double-buffered pixel buffer objects
+*/
+
+#include "TextureStream.h"
+
+TextureStream::TextureStream() : texture_id(0), pbo_index(0), width(0), height(0), mapped(false)
+{
+    glGenTextures(1, &texture_id);
+    glGenBuffers(2, pbo_ids);
+
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+TextureStream::~TextureStream()
+{
+    glDeleteBuffers(2, pbo_ids);
+    glDeleteTextures(1, &texture_id);
+}
+
+// Input: frame dimensions in pixels
+// Returns: pointer to width*height pixels backed by driver memory, valid until unmap
+uint32_t* TextureStream::map(int frame_width, int frame_height)
+{
+    if (mapped || frame_width <= 0 || frame_height <= 0)
+    {
+        return nullptr;
+    }
+
+    if (frame_width != width || frame_height != height)
+    {
+        resize(frame_width, frame_height);
+    }
+
+    // orphan the buffer so the driver never stalls on a frame it is still uploading
+    const GLsizeiptr size = GLsizeiptr(width) * height * sizeof(uint32_t);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ids[pbo_index]);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* pixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (pixels == nullptr)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return nullptr;
+    }
+
+    mapped = true;
+    return static_cast<uint32_t*>(pixels);
+}
+
+void TextureStream::unmap()
+{
+    if (!mapped)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_ids[pbo_index]);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // source pointer is an offset into the bound pixel buffer, the copy happens asynchronously in the driver
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, reinterpret_cast<void*>(0));
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    pbo_index ^= 1;
+    mapped = false;
+}
+
+void TextureStream::bind(unsigned int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+}
+
+void TextureStream::resize(int new_width, int new_height)
+{
+    width = new_width;
+    height = new_height;
+
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
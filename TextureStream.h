@@ -0,0 +1,50 @@
+/* 
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26 
+ 
+Description: Streams CPU rendered RGBA frames into an OpenGL texture through
+             double-buffered pixel buffer objects
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include <GL/glew.h>  // includes typedefs for OpenGL
+
+class TextureStream
+{
+    public:
+        // -methods- //
+
+        // Requires a current OpenGL context, texture storage is allocated on first map
+        TextureStream();
+        ~TextureStream();
+        TextureStream(const TextureStream&) = delete;
+        TextureStream& operator=(const TextureStream&) = delete;
+
+        // Maps the next pixel buffer for writing width*height packed RGBA pixels (row 0 is the top of the frame)
+        // Returns: pointer to the mapped pixels or nullptr if the buffer could not be mapped
+        uint32_t* map(int width, int height);
+
+        // Unmaps the pixel buffer and uploads it into the texture
+        void unmap();
+
+        // Binds the streamed texture to the given texture unit
+        void bind(unsigned int unit = 0) const;
+
+    private:
+        // -members- //
+        GLuint texture_id;
+        GLuint pbo_ids[2];
+        int pbo_index;  // pixel buffer written this frame, the other one may still be read by the driver
+        int width;
+        int height;
+        bool mapped;
+
+        // -methods- //
+
+        // Reallocates texture storage when the frame size changes
+        void resize(int new_width, int new_height);
+};
@@ -9,41 +9,79 @@ Description: Handles SFML window events including menu select, zoom/pan, and win
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
 #include <GL/glew.h>
 #include <SFML/OpenGL.hpp>
 #include <SFML/Graphics.hpp>
 
+#include "Mandelbrot/mandelbrot_omp.h"
+#include "Mandelbrot/perturbation.h"
+#include "Mandelbrot/tile_cache.h"
+#include "ScaledTarget.h"
+#include "ShaderCache.h"
+
 enum class FractalMode
 {
     SHADER_MANDELBROT,
     SHADER_JULIA,
     OPENMP_MANDELBROT,
+    OPENMP_JULIA,         // CPU formula engine modes, rendered like OPENMP_MANDELBROT with another formula
+    OPENMP_MULTIBROT,
+    OPENMP_BURNING_SHIP,
+    OPENMP_TRICORN,
     NONE
 };
 
+// Returns: true for the modes rendered on the CPU by the render thread
+inline bool cpuMode(FractalMode mode)
+{
+    return mode == FractalMode::OPENMP_MANDELBROT || mode == FractalMode::OPENMP_JULIA || mode == FractalMode::OPENMP_MULTIBROT
+        || mode == FractalMode::OPENMP_BURNING_SHIP || mode == FractalMode::OPENMP_TRICORN;
+}
+
 
 struct WindowState
 {
     public: 
+        static constexpr double floatZoomLimit = 1e-5;        // float coordinates blur into blocks below this zoom
+        static constexpr double doubleFloatZoom = 1e-4;       // shaders switch to float-float arithmetic below this zoom
+        static constexpr double doubleFloatZoomLimit = 1e-11;  // float-float stays within a few percent of exact pixels down to this zoom
+        static constexpr float minResolutionScale = 0.25f;    // shader frames never drop below a quarter of the window resolution
+        static constexpr float refineStep = 1.5f;             // resolution growth per frame once the view stops moving
+
         bool windowActive;
         bool fractalView;  // used for when mode is selected, can exit to menu
-        float zoom;
-        float frame_x;
-        float frame_y;
+        double zoom;     // double so the float-float shaders get a center below float precision
+        double frame_x;
+        double frame_y;
         int mouse_x;
         int mouse_y;
         bool panning;
-        float maxZoom;
+        double maxZoom;  // deepest zoom the current mode resolves
         int window_x;  // dim in pixels
         int window_y;  // dim in pixels
         bool shadersInit;
+        bool viewChanged;  // set whenever zoom, pan or window size change, cleared by the renderer
+        bool redraw;       // the screen is out of date, set with viewChanged and by new CPU frames, cleared once presented
+        omp::RenderOptions renderOptions;  // CPU renderer settings (kernel select), interior checks also drive the shaders
+        bool deepZoom;           // OpenMP view rendered by perturbation around deepView instead of the float kernels
+        omp::DeepView deepView;  // fixed-point center and double zoom of the deep mode
+        double frameBudget;     // milliseconds a shader frame may take while the view moves
+        float resolutionScale;  // offscreen resolution of shader frames relative to the window
+        bool supersample;       // still shader frames converge to 2x2 supersampling instead of the window resolution
+        bool statsOverlay;    // frame statistics from the trace buffers are shown in the title bar
+        bool traceRequested;  // set by the trace key, cleared once main has written the trace file
     private:
-        const GLuint program_id;
+        const ShaderProgram* program;  // program the uniforms go to, owned by the ShaderCache
 
     public:
-        WindowState(GLuint program_id, int window_x, int window_y, float maxZoom = std::numeric_limits<float>::min()) : program_id(program_id), \
-                                window_x(window_x), window_y(window_y), windowActive(true), fractalView(false), zoom(1.f), \
-                                frame_x(0.f), frame_y(0.f), mouse_x(0), mouse_y(0), panning(false), maxZoom(maxZoom), shadersInit(false)
+        WindowState(int window_x, int window_y, double maxZoom = floatZoomLimit) : program(nullptr), \
+                                window_x(window_x), window_y(window_y), windowActive(true), fractalView(false), zoom(1.0), \
+                                frame_x(0.0), frame_y(0.0), mouse_x(0), mouse_y(0), panning(false), maxZoom(maxZoom), shadersInit(false), viewChanged(true), redraw(true), \
+                                deepZoom(false), frameBudget(16.0), resolutionScale(1.0f), supersample(false), statsOverlay(false), traceRequested(false)
         {
             this->updateFrameUniforms();
             this->updateWindowSizeUniforms();
@@ -66,12 +104,39 @@ struct WindowState
             }
             else if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Num3))
             {
-                return FractalMode::OPENMP_MANDELBROT;
+                return this->selectFormula(FractalMode::OPENMP_MANDELBROT, omp::Formula::MANDELBROT);
+            }
+            else if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Num4))
+            {
+                return this->selectFormula(FractalMode::OPENMP_JULIA, omp::Formula::JULIA);
+            }
+            else if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Num5))
+            {
+                return this->selectFormula(FractalMode::OPENMP_MULTIBROT, omp::Formula::MULTIBROT3);
+            }
+            else if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Num6))
+            {
+                return this->selectFormula(FractalMode::OPENMP_BURNING_SHIP, omp::Formula::BURNING_SHIP);
+            }
+            else if ((event.type == sf::Event::KeyPressed) && (event.key.code == sf::Keyboard::Num7))
+            {
+                return this->selectFormula(FractalMode::OPENMP_TRICORN, omp::Formula::TRICORN);
             }
 
             return FractalMode::NONE;
         }
 
+        // Sets the formula the CPU renderer iterates for a menu entry, perturbation only exists for the Mandelbrot formula
+        FractalMode selectFormula(FractalMode mode, omp::Formula formula)
+        {
+            renderOptions.formula.type = formula;
+            if (formula != omp::Formula::MANDELBROT)
+            {
+                deepZoom = false;
+            }
+            return mode;
+        }
+
         // Handles event in fractal visualization view (zoom, pan, window resize, return to main menu)
         void handleEvent(const sf::Event& event)
         {
@@ -85,13 +150,30 @@ struct WindowState
                 window_y = event.size.height;
                 glViewport(0, 0, window_x, window_y);  // adjust window size
                 this->updateWindowSizeUniforms();
+                if (renderOptions.tileCache)
+                {
+                    this->snapToPyramid(0);
+                }
+                viewChanged = redraw = true;
             }
             else if (event.type == sf::Event::MouseWheelScrolled)
             {
-                zoom = zoom * (1 - .07 * event.mouseWheelScroll.delta);
-                zoom = (zoom > 1.0f) ? 1.0f : zoom;
-                zoom = (zoom < .00001f) ? .00001f: zoom;
+                if (deepZoom)
+                {
+                    this->zoomDeep(1 - .07 * event.mouseWheelScroll.delta);
+                }
+                if (renderOptions.tileCache)
+                {
+                    this->snapToPyramid((event.mouseWheelScroll.delta > 0) ? 1 : -1);  // one pyramid level per notch
+                }
+                else
+                {
+                    zoom = zoom * (1 - .07 * event.mouseWheelScroll.delta);
+                    zoom = (zoom > 1.0) ? 1.0 : zoom;
+                    zoom = (zoom < maxZoom) ? maxZoom : zoom;
+                }
                 this->updateFrameUniforms();
+                viewChanged = redraw = true;
             }
             else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Button::Left)
             {
@@ -105,22 +187,242 @@ struct WindowState
             }
             else if (event.type == sf::Event::MouseMoved && panning)
             {
-                frame_x += (mouse_x - event.mouseMove.x) / float(window_x) * zoom; 
-                frame_y += (event.mouseMove.y - mouse_y) / float(window_y) * zoom;
-                frame_x = (frame_x > 1.0f) ? 1.0f : frame_x;
-                frame_x = (frame_x < -1.0f) ? -1.0f : frame_x;
-                frame_y = (frame_y > 1.0f) ? 1.0f : frame_y;
-                frame_y = (frame_y < -1.0f) ? -1.0f : frame_y;
+                // one pixel is zoom / min_dim in frame units (see updateWindowSizeUniforms), so the fractal follows the cursor
+                // and the CPU renderer sees a pan by whole pixels it can reuse
+                int min_dim = (window_x < window_y) ? window_x : window_y;
+                if (deepZoom)
+                {
+                    this->panDeep(mouse_x - event.mouseMove.x, event.mouseMove.y - mouse_y, min_dim);
+                }
+                frame_x += (mouse_x - event.mouseMove.x) / double(min_dim) * zoom; 
+                frame_y += (event.mouseMove.y - mouse_y) / double(min_dim) * zoom;
+                frame_x = (frame_x > 1.0) ? 1.0 : frame_x;
+                frame_x = (frame_x < -1.0) ? -1.0 : frame_x;
+                frame_y = (frame_y > 1.0) ? 1.0 : frame_y;
+                frame_y = (frame_y < -1.0) ? -1.0 : frame_y;
                 mouse_x = event.mouseMove.x;
                 mouse_y = event.mouseMove.y;
                 this->updateFrameUniforms();
+                viewChanged = redraw = true;
             }
             else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R)
             {
                 zoom = 1; // reset zoom and frame
                 frame_x = 0;
                 frame_y = 0;
+                if (deepZoom)
+                {
+                    deepView = omp::DeepView();
+                }
                 this->updateFrameUniforms();
+                viewChanged = redraw = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::K)
+            {
+                this->cycleKernel();
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::M)
+            {
+                bool subdivide = renderOptions.algorithm != omp::Algorithm::MARIANI_SILVER;
+                renderOptions.algorithm = subdivide ? omp::Algorithm::MARIANI_SILVER : omp::Algorithm::BRUTE_FORCE;
+                std::cout << "CPU algorithm: " << (subdivide ? "Mariani-Silver" : "brute force") << std::endl;
+                viewChanged = redraw = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::C)
+            {
+                renderOptions.interior.cardioid = !renderOptions.interior.cardioid;
+                std::cout << "Cardioid/bulb check: " << (renderOptions.interior.cardioid ? "on" : "off") << std::endl;
+                this->updateInteriorUniforms();
+                viewChanged = redraw = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P)
+            {
+                renderOptions.interior.periodicity = !renderOptions.interior.periodicity;
+                std::cout << "Periodicity check: " << (renderOptions.interior.periodicity ? "on" : "off") << std::endl;
+                this->updateInteriorUniforms();
+                viewChanged = redraw = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::D)
+            {
+                this->toggleDeepZoom();
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::G)
+            {
+                renderOptions.tileCache = !renderOptions.tileCache;
+                std::cout << "Tile cache: " << (renderOptions.tileCache ? "on, zoom snaps to the tile pyramid" : "off") << std::endl;
+                if (renderOptions.tileCache)
+                {
+                    this->snapToPyramid(0);
+                }
+                viewChanged = redraw = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S)
+            {
+                supersample = !supersample;
+                std::cout << "Shader supersampling: " << (supersample ? "on" : "off") << std::endl;
+                redraw = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::O)
+            {
+                renderOptions.color.palette = static_cast<omp::Palette>((static_cast<int>(renderOptions.color.palette) + 1) % omp::paletteCount);
+                std::cout << "Palette: " << omp::paletteName(renderOptions.color.palette) << std::endl;
+                viewChanged = redraw = true;  // the render thread recolors the finished frame
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H)
+            {
+                renderOptions.color.histogram = !renderOptions.color.histogram;
+                std::cout << "Histogram coloring: " << (renderOptions.color.histogram ? "on" : "off") << std::endl;
+                viewChanged = redraw = true;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F)
+            {
+                renderOptions.color.smooth = !renderOptions.color.smooth;
+                std::cout << "Smooth coloring: " << (renderOptions.color.smooth ? "on" : "off") << std::endl;
+                viewChanged = redraw = true;  // the first switch on calculates the fractional counts
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::I)
+            {
+                statsOverlay = !statsOverlay;
+            }
+            else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::T)
+            {
+                traceRequested = true;
+            }
+        }
+
+        // Snapshot of the view for the CPU render thread, its frame buffer follows the window size
+        omp::View snapshot() const
+        {
+            omp::View view;
+            view.width = window_x;
+            view.height = window_y;
+            view.zoom = float(zoom);
+            view.frame_x = float(frame_x);
+            view.frame_y = float(frame_y);
+            view.options = renderOptions;
+            if (deepZoom)
+            {
+                view.deep = std::make_shared<const omp::DeepView>(deepView);
+            }
+            return view;
+        }
+
+        // Switches the OpenMP view between the float kernels and perturbation, the deep view starts at the current frame
+        void toggleDeepZoom()
+        {
+            if (!deepZoom && renderOptions.formula.type != omp::Formula::MANDELBROT)
+            {
+                std::cout << "Deep zoom: only for the Mandelbrot formula" << std::endl;
+                return;
+            }
+            deepZoom = !deepZoom;
+            if (deepZoom)
+            {
+                // same mapping as omp::pixelToReal/pixelToImag
+                deepView = omp::DeepView();
+                deepView.zoom = zoom;
+                deepView.maxIterations = omp::deepIterationLimit(zoom);
+                deepView.center_real = omp::FixedPoint(omp::FixedPoint::limbsForZoom(zoom), 5.0 * frame_x);
+                deepView.center_imag = omp::FixedPoint(omp::FixedPoint::limbsForZoom(zoom), -5.0 * frame_y);
+            }
+            viewChanged = redraw = true;
+            std::cout << "Deep zoom: " << (deepZoom ? "on" : "off") << std::endl;
+        }
+
+        // Scales the deep zoom, the center gains limbs as the view gets deeper so pans keep sub-pixel precision
+        void zoomDeep(double factor)
+        {
+            deepView.zoom = std::min(std::max(deepView.zoom * factor, omp::deepZoomLimit), 1.0);
+            deepView.maxIterations = omp::deepIterationLimit(deepView.zoom);
+            const int limbs = omp::FixedPoint::limbsForZoom(deepView.zoom);
+            if (limbs > deepView.center_real.precision())
+            {
+                deepView.center_real.setPrecision(limbs);
+                deepView.center_imag.setPrecision(limbs);
+            }
+        }
+
+        // Moves the deep center by a drag of dx, dy pixels, one pixel is 5 * zoom / min_dim in the complex plane
+        void panDeep(int dx, int dy, int min_dim)
+        {
+            const double pixel = 5.0 * deepView.zoom / min_dim;
+            const int limbs = deepView.center_real.precision();
+            deepView.center_real += omp::FixedPoint(limbs, dx * pixel);
+            deepView.center_imag -= omp::FixedPoint(limbs, dy * pixel);
+        }
+
+        // Moves the view onto the pixel grid of the nearest tile pyramid level, levels steps deeper
+        // Pans by whole pixels keep the view on the grid, so only zoom and resize need to snap again
+        void snapToPyramid(int levels)
+        {
+            int min_dim = (window_x < window_y) ? window_x : window_y;
+            int level = int(std::lround(-std::log2(zoom / min_dim * omp::pyramidTileSize))) + levels;
+            level = std::min(std::max(level, 0), omp::pyramidMaxLevel);
+            while (level < omp::pyramidMaxLevel && std::ldexp(double(min_dim) / omp::pyramidTileSize, -level) > 1.0)
+            {
+                ++level;  // the whole pyramid level must fit the zoom range
+            }
+            while (level > 0 && std::ldexp(double(min_dim) / omp::pyramidTileSize, -level) < maxZoom)
+            {
+                --level;
+            }
+
+            double pixel = std::ldexp(1.0, -level) / omp::pyramidTileSize;
+            zoom = pixel * min_dim;
+            frame_x = (std::round(frame_x / pixel - min_dim / 2.0) + min_dim / 2.0) * pixel;
+            frame_y = -(std::round(-frame_y / pixel - min_dim / 2.0) + min_dim / 2.0) * pixel;
+            this->updateFrameUniforms();
+        }
+
+        // Switches the CPU renderer to the next kernel supported by this machine
+        void cycleKernel()
+        {
+            do
+            {
+                renderOptions.kernel = static_cast<omp::Kernel>((static_cast<int>(renderOptions.kernel) + 1) % (static_cast<int>(omp::Kernel::AVX512) + 1));
+            } while (!omp::kernelSupported(renderOptions.kernel));
+            viewChanged = redraw = true;  // re-render so the new kernel can be timed
+            std::cout << "CPU kernel: " << omp::kernelName(renderOptions.kernel) << " (" << omp::kernelName(omp::resolveKernel(renderOptions.kernel)) << ")" << std::endl;
+        }
+
+        // Makes program the target of the uniform updates and sends it the current view
+        void useProgram(const ShaderProgram* next)
+        {
+            program = next;
+            shadersInit = program != nullptr;
+            this->updateFrameUniforms();
+            this->updateWindowSizeUniforms();
+            this->updateInteriorUniforms();
+        }
+
+        // Returns: resolution scale shader frames converge to once the view stops moving
+        float idleScale() const
+        {
+            return supersample ? 2.0f : 1.0f;
+        }
+
+        // Picks the resolution scale of the next shader frame: a moving view gets the largest scale whose estimated
+        // frame time fits the budget, a still view grows a step per frame up to idleScale
+        void adaptResolution(double fullFrameMilliseconds, bool interacting)
+        {
+            float next = resolutionScale;
+            if (interacting)
+            {
+                if (fullFrameMilliseconds > 0.0)
+                {
+                    next = float(std::sqrt(frameBudget / fullFrameMilliseconds));  // the cost grows with the pixel count
+                }
+                next = std::min(std::max(next, minResolutionScale), 1.0f);
+            }
+            else
+            {
+                next = std::min(resolutionScale * refineStep, this->idleScale());
+            }
+
+            if (next != resolutionScale)
+            {
+                resolutionScale = next;
+                this->updateWindowSizeUniforms();
             }
         }
 
@@ -129,10 +431,27 @@ struct WindowState
         {
             if (shadersInit)
             {
-                glUseProgram(program_id);
-                glUniform1f(glGetUniformLocation(program_id, "zoom"), zoom);
-                glUniform1f(glGetUniformLocation(program_id, "frame_x"), frame_x);
-                glUniform1f(glGetUniformLocation(program_id, "frame_y"), frame_y);
+                glUseProgram(program->id);
+                // the center is split into hi + lo floats for the float-float shader path
+                float frame_x_hi = float(frame_x);
+                float frame_y_hi = float(frame_y);
+                glUniform1f(program->uniform("zoom"), float(zoom));
+                glUniform1f(program->uniform("frame_x"), frame_x_hi);
+                glUniform1f(program->uniform("frame_y"), frame_y_hi);
+                glUniform1f(program->uniform("frame_x_lo"), float(frame_x - frame_x_hi));
+                glUniform1f(program->uniform("frame_y_lo"), float(frame_y - frame_y_hi));
+                glUniform1i(program->uniform("doubleFloat"), zoom < doubleFloatZoom);
+            }
+        }
+
+        // Updates the interior short-circuit switches if shaders are currently being used, shaders without them ignore the call
+        void updateInteriorUniforms()
+        {
+            if (shadersInit)
+            {
+                glUseProgram(program->id);
+                glUniform1i(program->uniform("cardioidCheck"), renderOptions.interior.cardioid);
+                glUniform1i(program->uniform("periodicityCheck"), renderOptions.interior.periodicity);
             }
         }
 
@@ -141,11 +460,12 @@ struct WindowState
         {
             if (shadersInit)
             {
-                glUseProgram(program_id);
+                glUseProgram(program->id);
                 // don't allow horizontal or vertical stretching, get min of two arguments
-                int min_dim = (window_x < window_y) ? window_x : window_y;
-                glUniform1i(glGetUniformLocation(program_id, "width"), min_dim);
-                glUniform1i(glGetUniformLocation(program_id, "height"), min_dim);
+                // shaders draw into the offscreen frame, whose pixels are resolutionScale window pixels
+                int min_dim = ScaledTarget::scaled((window_x < window_y) ? window_x : window_y, resolutionScale);
+                glUniform1i(program->uniform("width"), min_dim);
+                glUniform1i(program->uniform("height"), min_dim);
             }
         }
 };
@@ -0,0 +1,497 @@
+/*
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Benchmark and regression check for the OpenMP Mandelbrot kernels
+             Times every kernel on a fixed catalogue of views, measures thread scaling and
+             compares the iteration counts against the scalar reference and recorded golden hashes
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Mandelbrot/mandelbrot_omp.h"
+#include "Mandelbrot/mariani_silver.h"
+#include "Mandelbrot/symmetry.h"
+
+namespace {
+
+const char* usage =
+    "Usage: fractal_bench [options]\n"
+    "  --size WxH            frame size (default 1024x768)\n"
+    "  --repeat N            timed runs per measurement, the median is reported (default 5)\n"
+    "  --threads LIST        thread counts of the scaling curve, e.g. 1,2,4,8 (default powers of two up to the core count)\n"
+    "  --json FILE           write the results as JSON\n"
+    "  --golden FILE         compare the counts against hashes recorded with --record-golden\n"
+    "  --record-golden FILE  record the hashes of the scalar reference\n";
+
+// Catalogue entry, the center is the middle of the frame
+struct BenchView
+{
+    const char* name;
+    double real;
+    double imag;
+    float zoom;
+};
+
+const BenchView catalogue[] = {
+    {"full", -0.75, 0.0, 0.7f},                      // whole set, mostly cheap exterior
+    {"boundary", -0.7436, 0.1318, 0.005f},           // seahorse valley, counts change every few pixels
+    {"interior", -0.1, 0.1, 0.01f},                  // inside the main cardioid, every pixel runs to the limit
+    {"spiral", -0.761574, -0.0847596, 0.0005f},      // deep spiral, long escape times
+};
+
+// Way of calculating a frame, exact variants must reproduce the scalar counts bit for bit
+struct Variant
+{
+    std::string name;
+    omp::RenderOptions options;
+    bool exact;
+    bool formulaEngine = false;  // run every pixel through formulaRow, even for the float Mandelbrot formula the kernels cover
+};
+
+struct Measurement
+{
+    std::string view;
+    std::string variant;
+    unsigned threads;
+    double seconds;        // median of the timed runs
+    double pixelRate;      // pixels per second
+    double iterationRate;  // iterations represented by the frame per second
+    double evaluated;      // fraction of the pixels whose iterations were calculated
+    uint64_t hash;
+    bool matches;          // counts equal the scalar reference
+};
+
+using Clock = std::chrono::steady_clock;
+
+// FNV-1a over the counts, row by row so the stride padding is ignored
+uint64_t hashFrame(const omp::FrameBuffer& frame)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (int y = 0; y < frame.height(); ++y)
+    {
+        const uint16_t* row = frame.row(y);
+        for (int x = 0; x < frame.width(); ++x)
+        {
+            hash = (hash ^ (row[x] & 0xFF)) * 1099511628211ull;
+            hash = (hash ^ (row[x] >> 8)) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// FNV-1a over the colored pixels, byte by byte
+uint64_t hashPixels(const std::vector<uint32_t>& pixels)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t pixel : pixels)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            hash = (hash ^ ((pixel >> shift) & 0xFF)) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// Counts of the frame row by row, without the stride padding
+std::vector<uint16_t> copyCounts(const omp::FrameBuffer& frame)
+{
+    std::vector<uint16_t> counts;
+    counts.reserve(std::size_t(frame.width()) * frame.height());
+    for (int y = 0; y < frame.height(); ++y)
+    {
+        counts.insert(counts.end(), frame.row(y), frame.row(y) + frame.width());
+    }
+    return counts;
+}
+
+// Number of pixels whose count differs from the reference counts
+std::size_t differingPixels(const omp::FrameBuffer& frame, const std::vector<uint16_t>& reference)
+{
+    std::size_t differing = 0;
+    for (int y = 0; y < frame.height(); ++y)
+    {
+        const uint16_t* row = frame.row(y);
+        const uint16_t* expected = reference.data() + std::size_t(y) * frame.width();
+        for (int x = 0; x < frame.width(); ++x)
+        {
+            differing += (row[x] != expected[x]) ? 1 : 0;
+        }
+    }
+    return differing;
+}
+
+// Iterations the counts stand for, escaped pixels ran one more iteration than their count
+uint64_t frameIterations(const omp::FrameBuffer& frame)
+{
+    uint64_t total = 0;
+    for (int y = 0; y < frame.height(); ++y)
+    {
+        const uint16_t* row = frame.row(y);
+        for (int x = 0; x < frame.width(); ++x)
+        {
+            total += (row[x] >= omp::MAX_ITERATIONS) ? row[x] : row[x] + 1;
+        }
+    }
+    return total;
+}
+
+// Runs calculate repeat times after one warm-up run, returns the median time in seconds
+template <typename Function>
+double timeMedian(int repeat, Function calculate)
+{
+    calculate();
+    std::vector<double> times;
+    for (int k = 0; k < repeat; ++k)
+    {
+        const Clock::time_point start = Clock::now();
+        calculate();
+        times.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Brute force frame on a pool of the given size, so thread scaling can be measured outside the shared pool
+void renderOnPool(omp::TileScheduler& pool, omp::FrameBuffer& frame, float zoom, float frame_x, float frame_y, const omp::RenderOptions& options)
+{
+    const int minDim = std::min(frame.width(), frame.height());
+    omp::RenderOptions resolved = options;
+    resolved.kernel = omp::resolveKernel(options.kernel);
+    std::vector<omp::Tile> tiles = omp::TileScheduler::makeTiles(frame.width(), frame.height(), options.tileSize);
+    for (omp::Tile& tile : tiles)
+    {
+        tile.cost = omp::estimateTileCost(tile, minDim, minDim, zoom, frame_x, frame_y);
+    }
+    pool.run(std::move(tiles), [&](const omp::Tile& tile) { omp::renderTile(frame, tile, zoom, frame_x, frame_y, resolved); });
+}
+
+// Frame of a variant on the shared pool, through mandelbrotSet unless the variant asks for the formula engine
+// Returns: number of pixels whose iterations were calculated, the rest were filled or mirrored
+uint64_t renderVariant(omp::FrameBuffer& frame, float zoom, float frame_x, float frame_y, const Variant& variant)
+{
+    const uint64_t pixels = uint64_t(frame.width()) * frame.height();
+    if (variant.options.algorithm == omp::Algorithm::MARIANI_SILVER)
+    {
+        uint64_t evaluated = 0;
+        omp::marianiSilver(frame, zoom, frame_x, frame_y, variant.options, nullptr, &evaluated);
+        return evaluated;
+    }
+    if (!variant.formulaEngine)
+    {
+        omp::mandelbrotSet(frame, zoom, frame_x, frame_y, variant.options);
+        if (!variant.options.symmetry)
+        {
+            return pixels;
+        }
+        const std::vector<int> mirror = omp::mirrorRows(frame.height(), std::min(frame.width(), frame.height()), zoom, frame_y);
+        return pixels - uint64_t(omp::mirroredRowCount(mirror)) * frame.width();
+    }
+    const int minDim = std::min(frame.width(), frame.height());
+    std::vector<omp::Tile> tiles = omp::TileScheduler::makeTiles(frame.width(), frame.height(), variant.options.tileSize);
+    for (omp::Tile& tile : tiles)
+    {
+        tile.cost = omp::estimateTileCost(tile, minDim, minDim, zoom, frame_x, frame_y);
+    }
+    omp::TileScheduler::instance().run(std::move(tiles), [&](const omp::Tile& tile)
+    {
+        for (int y = tile.y; y < tile.y + tile.height; ++y)
+        {
+            omp::formulaRow(variant.options.formula, frame.row(y) + tile.x, nullptr, tile.x, y, tile.width, minDim, minDim, zoom, frame_x, frame_y);
+        }
+    });
+    return pixels;
+}
+
+// Palette and mapping of the coloring pass, exact variants must reproduce getColor
+struct ColorVariant
+{
+    std::string name;
+    omp::ColorOptions options;
+    bool exact;
+};
+
+std::vector<ColorVariant> colorVariants()
+{
+    std::vector<ColorVariant> result{{"color-classic", omp::ColorOptions(), true}};
+    omp::ColorOptions fire;
+    fire.palette = omp::Palette::FIRE;
+    result.push_back({"color-fire", fire, false});
+    omp::ColorOptions equalized;
+    equalized.palette = omp::Palette::OCEAN;
+    equalized.histogram = true;  // the frame has no smooth channel, so smooth would only add the check
+    result.push_back({"color-histogram", equalized, false});
+    return result;
+}
+
+std::vector<Variant> variants()
+{
+    std::vector<Variant> result;
+    for (omp::Kernel kernel : {omp::Kernel::SCALAR, omp::Kernel::AVX2, omp::Kernel::AVX512})
+    {
+        if (omp::kernelSupported(kernel))
+        {
+            Variant variant{omp::kernelName(kernel), omp::RenderOptions(), true};
+            variant.options.kernel = kernel;
+            variant.options.symmetry = false;  // every pixel through the kernel, so kernels compare on equal work
+            result.push_back(variant);
+        }
+    }
+
+    Variant symmetry{"symmetry", omp::RenderOptions(), true};  // rows mirrored about the real axis are copied, counts stay exact
+    result.push_back(symmetry);
+
+    // the templated formula engine every other formula runs on, its float Mandelbrot loop gives the same counts
+    Variant formula{"formula", omp::RenderOptions(), true, true};
+    result.push_back(formula);
+
+    Variant mariani{"mariani", omp::RenderOptions(), true};  // fills escaping and cardioid/bulb rectangles, counts stay exact
+    mariani.options.algorithm = omp::Algorithm::MARIANI_SILVER;
+    result.push_back(mariani);
+
+    Variant interior{"interior-checks", omp::RenderOptions(), false};  // periodicity detection may stop orbits early
+    interior.options.interior.cardioid = true;
+    interior.options.interior.periodicity = true;
+    result.push_back(interior);
+    return result;
+}
+
+bool readGolden(const std::string& path, std::map<std::string, uint64_t>& golden)
+{
+    std::ifstream file(path);
+    std::string name;
+    std::string hash;
+    while (file >> name >> hash)
+    {
+        golden[name] = std::strtoull(hash.c_str(), nullptr, 16);
+    }
+    return !golden.empty();
+}
+
+void writeJson(std::ostream& out, int width, int height, const std::vector<Measurement>& results)
+{
+    out << "{\n  \"width\": " << width << ",\n  \"height\": " << height << ",\n  \"kernel\": \"" << omp::kernelName(omp::resolveKernel(omp::Kernel::AUTO))
+        << "\",\n  \"results\": [\n";
+    for (std::size_t k = 0; k < results.size(); ++k)
+    {
+        const Measurement& m = results[k];
+        out << "    {\"view\": \"" << m.view << "\", \"variant\": \"" << m.variant << "\", \"threads\": " << m.threads
+            << ", \"seconds\": " << m.seconds << ", \"mpixels_per_second\": " << m.pixelRate / 1e6
+            << ", \"giterations_per_second\": " << m.iterationRate / 1e9 << ", \"evaluated\": " << m.evaluated << ", \"hash\": \"" << std::hex << m.hash << std::dec
+            << "\", \"matches_reference\": " << (m.matches ? "true" : "false") << "}" << (k + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+}  // namespace
+
+
+int main(int argc, char* argv[])
+{
+    int width = 1024;
+    int height = 768;
+    int repeat = 5;
+    std::vector<unsigned> threadCounts;
+    std::string jsonPath;
+    std::string goldenPath;
+    std::string recordPath;
+
+    for (int k = 1; k < argc; ++k)
+    {
+        const std::string option = argv[k];
+        const char* value = (k + 1 < argc) ? argv[k + 1] : nullptr;
+        bool valid = value != nullptr;
+        if (option == "-h" || option == "--help")
+        {
+            std::cout << usage;
+            return EXIT_SUCCESS;
+        }
+        else if (option == "--size" && valid)
+        {
+            valid = std::sscanf(value, "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+        }
+        else if (option == "--repeat" && valid)
+        {
+            repeat = std::atoi(value);
+            valid = repeat > 0;
+        }
+        else if (option == "--threads" && valid)
+        {
+            std::stringstream list(value);
+            for (std::string item; std::getline(list, item, ',');)
+            {
+                threadCounts.push_back(unsigned(std::max(1, std::atoi(item.c_str()))));
+            }
+        }
+        else if (option == "--json" && valid)
+        {
+            jsonPath = value;
+        }
+        else if (option == "--golden" && valid)
+        {
+            goldenPath = value;
+        }
+        else if (option == "--record-golden" && valid)
+        {
+            recordPath = value;
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            std::cerr << "invalid option " << option << "\n" << usage;
+            return EXIT_FAILURE;
+        }
+        ++k;
+    }
+
+    if (threadCounts.empty())
+    {
+        const unsigned hardware = omp::TileScheduler::instance().threadCount();  // the CPUs this process may use
+        for (unsigned threads = 1; threads < hardware; threads *= 2)
+        {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(hardware);
+    }
+
+    std::map<std::string, uint64_t> golden;
+    if (!goldenPath.empty() && !readGolden(goldenPath, golden))
+    {
+        std::cerr << goldenPath << ": no golden hashes" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string size = std::to_string(width) + "x" + std::to_string(height);
+    std::cout << "fractal_bench " << size << ", " << omp::TileScheduler::instance().threadCount() << " threads, median of " << repeat << " runs\n"
+              << std::left << std::setw(10) << "view" << std::setw(17) << "variant" << std::right << std::setw(8) << "threads"
+              << std::setw(11) << "ms" << std::setw(12) << "Mpixel/s" << std::setw(12) << "Giter/s" << std::setw(10) << "iterated" << "  check\n";
+
+    std::vector<Measurement> results;
+    std::ofstream record;
+    if (!recordPath.empty())
+    {
+        record.open(recordPath);
+    }
+    int failures = 0;
+    omp::FrameBuffer frame(width, height);
+    const auto report = [&](Measurement m, const std::string& check)
+    {
+        std::cout << std::left << std::setw(10) << m.view << std::setw(17) << m.variant << std::right << std::setw(8) << m.threads
+                  << std::fixed << std::setprecision(2) << std::setw(11) << m.seconds * 1e3 << std::setw(12) << m.pixelRate / 1e6
+                  << std::setw(12) << m.iterationRate / 1e9 << std::setw(9) << m.evaluated * 100.0 << "%  " << check << std::defaultfloat << "\n";
+        results.push_back(m);
+    };
+
+    for (const BenchView& view : catalogue)
+    {
+        float frame_x = 0.f;
+        float frame_y = 0.f;
+        omp::centerFrame(view.real, view.imag, width, height, view.zoom, frame_x, frame_y);
+        const double pixels = double(width) * height;
+
+        // the one pixel at a time loop everything is checked against
+        const double reference = timeMedian(repeat, [&]()
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                uint16_t* row = frame.row(y);
+                for (int x = 0; x < width; ++x)
+                {
+                    row[x] = uint16_t(omp::getIterations(x, y, std::min(width, height), std::min(width, height), view.zoom, frame_x, frame_y));
+                }
+            }
+        });
+        const uint64_t referenceHash = hashFrame(frame);
+        const std::vector<uint16_t> referenceCounts = copyCounts(frame);
+        const double iterations = double(frameIterations(frame));
+        const std::string key = std::string(view.name) + "@" + size;
+        if (record.is_open())
+        {
+            record << key << " " << std::hex << referenceHash << std::dec << "\n";
+        }
+
+        std::string check = "reference";
+        bool goldenOk = true;
+        if (golden.count(key) != 0 && golden[key] != referenceHash)
+        {
+            check = "GOLDEN MISMATCH";
+            goldenOk = false;
+            ++failures;
+        }
+        report({view.name, "getIterations", 1, reference, pixels / reference, iterations / reference, 1.0, referenceHash, goldenOk}, check);
+
+        for (const Variant& variant : variants())
+        {
+            uint64_t evaluated = 0;
+            const double seconds = timeMedian(repeat, [&]() { evaluated = renderVariant(frame, view.zoom, frame_x, frame_y, variant); });
+            const uint64_t hash = hashFrame(frame);
+            const std::size_t differing = differingPixels(frame, referenceCounts);
+            const bool matches = hash == referenceHash && differing == 0;
+            if (variant.exact && !matches)
+            {
+                ++failures;
+            }
+            const std::string differs = std::to_string(differing) + " pixels differ";
+            report({view.name, variant.name, omp::TileScheduler::instance().threadCount(), seconds, pixels / seconds, iterations / seconds, evaluated / pixels, hash, matches},
+                   matches ? "ok" : (variant.exact ? "MISMATCH, " + differs : differs + " (expected)"));
+        }
+
+        // scaling curve of the default kernel on private pools
+        for (unsigned threads : threadCounts)
+        {
+            omp::TileScheduler pool(threads);
+            const double seconds = timeMedian(repeat, [&]() { renderOnPool(pool, frame, view.zoom, frame_x, frame_y, omp::RenderOptions()); });
+            const uint64_t hash = hashFrame(frame);
+            failures += (hash == referenceHash) ? 0 : 1;
+            report({view.name, "scaling", threads, seconds, pixels / seconds, iterations / seconds, 1.0, hash, hash == referenceHash}, (hash == referenceHash) ? "ok" : "MISMATCH");
+        }
+
+        // coloring pass over the finished counts: the classic table must give getColor exactly, the others are timed only
+        std::vector<uint32_t> colors(std::size_t(width) * height);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                colors[std::size_t(y) * width + x] = omp::getColor(frame.at(x, y));
+            }
+        }
+        const uint64_t colorHash = hashPixels(colors);
+        for (const ColorVariant& variant : colorVariants())
+        {
+            const double seconds = timeMedian(repeat, [&]() { omp::colorize(frame, colors.data(), omp::MAX_ITERATIONS, variant.options); });
+            const uint64_t hash = hashPixels(colors);
+            const bool matches = hash == colorHash;
+            failures += (variant.exact && !matches) ? 1 : 0;
+            report({view.name, variant.name, omp::TileScheduler::instance().threadCount(), seconds, pixels / seconds, 0.0, 0.0, hash, matches},
+                   matches ? "ok" : (variant.exact ? "MISMATCH" : "recolored"));
+        }
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        writeJson(json, width, height, results);
+    }
+    if (failures > 0)
+    {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,650 @@
+/*
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26
+
+Description: Headless batch renderer, renders views with the OpenMP engine into PPM/PNG files
+             No window or GL context is created, so it runs on display-less machines
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Mandelbrot/animation.h"
+#include "Mandelbrot/image_writer.h"
+#include "Mandelbrot/mandelbrot_omp.h"
+#include "Mandelbrot/perturbation.h"
+#include "Mandelbrot/poster.h"
+#include "Mandelbrot/tile_store.h"
+
+#define FLOAT_ZOOM_LIMIT 1e-5  // float kernels blur into blocks below this zoom, deeper views use perturbation
+
+namespace {
+
+std::ostream* console = &std::cout;  // progress goes to stderr while a video is piped to stdout
+
+const char* usage =
+    "Usage: fractal_render [options]\n"
+    "  --center RE,IM      view center, decimals of any length (default 0,0)\n"
+    "  --zoom Z            the shorter image side spans 5 * Z in the complex plane, the longer one 5 * Z * long/short (default 1)\n"
+    "  --size WxH          image size in pixels (default 1920x1080)\n"
+    "  --iterations N      iteration limit up to 65535 (default 500, deeper for perturbation views)\n"
+    "  --fractal NAME      mandelbrot or deep (perturbation), deep is picked automatically\n"
+    "                      below zoom 1e-5 or for a limit other than 500\n"
+    "  --kernel NAME       auto, scalar, avx2 or avx512 (default auto)\n"
+    "  --formula NAME      mandelbrot, julia, multibrot3, multibrot4, burning-ship or tricorn (default mandelbrot),\n"
+    "                      formulas other than mandelbrot have no perturbation, tile pyramid or --iterations\n"
+    "  --julia RE,IM       constant of the julia formula (default 0.355534,-0.337292)\n"
+    "  --double            iterate in double precision, images stay sharp past zoom 1e-5 (down to about zoom 1e-13)\n"
+    "  --mariani           use Mariani-Silver subdivision\n"
+    "  --cardioid          answer points in the main cardioid and period-2 bulb without iterating, counts stay the same\n"
+    "  --palette NAME      classic, fire, ocean, grayscale or sine (default classic)\n"
+    "  --smooth            color by fractional iteration counts instead of bands\n"
+    "  --histogram         histogram-equalized colors, ignored by posters as each band would be equalized on its own\n"
+    "  --poster            stream the image to disk in bands, memory depends on the band height only,\n"
+    "                      an interrupted poster continues where it stopped when run again\n"
+    "  --band ROWS         rows per poster band (default 256)\n"
+    "  --out FILE          output image, .png or .ppm (default fractal.png)\n"
+    "  --animate FILE      render a zoom video along keyframes, one \"TIME RE,IM ZOOM\" per line, to --out\n"
+    "                      as Y4M (\"-\" or .y4m, for ffmpeg -i -) or raw RGB24 frames (other names)\n"
+    "  --fps N             animation frame rate (default 30)\n"
+    "  --jobs FILE         one render per line, each line holds options on top of the command line ones\n"
+    "  --pyramid FILE --level L --region RE0,IM0,RE1,IM1\n"
+    "                      precompute a region of the tile pyramid instead of rendering an image\n";
+
+// One render (or pyramid precompute) request
+struct Job
+{
+    std::string real = "0";
+    std::string imag = "0";
+    double zoom = 1.0;
+    int width = 1920;
+    int height = 1080;
+    int maxIterations = 0;  // 0 picks the limit the viewer would use
+    std::string fractal = "mandelbrot";
+    omp::RenderOptions options;
+    std::string out = "fractal.png";
+    bool poster = false;
+    int bandHeight = 256;
+    std::string animation;  // keyframe file of an animation job
+    int fps = 30;
+
+    std::string pyramid;  // set for a precompute job
+    int level = 0;
+    double region[4] = {0.0, 0.0, 0.0, 0.0};
+};
+
+bool parseKernel(const std::string& name, omp::Kernel& kernel)
+{
+    for (omp::Kernel candidate : {omp::Kernel::AUTO, omp::Kernel::SCALAR, omp::Kernel::AVX2, omp::Kernel::AVX512})
+    {
+        if (name == omp::kernelName(candidate))
+        {
+            kernel = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns: the kernel for the float mandelbrot formula, otherwise the formula with its precision and constant
+std::string formulaLabel(const omp::RenderOptions& options)
+{
+    const omp::FormulaOptions& formula = options.formula;
+    if (omp::classicFormula(formula))
+    {
+        return omp::kernelName(omp::resolveKernel(options.kernel));
+    }
+
+    std::ostringstream label;
+    label << omp::formulaName(formula.type);
+    if (formula.type == omp::Formula::JULIA)
+    {
+        label << " " << formula.julia_real << "," << formula.julia_imag;
+    }
+    label << (formula.doublePrecision ? " double" : " float");
+    return label.str();
+}
+
+// Splits "a,b,c" into numbers, returns false unless exactly count numbers are found
+bool parseList(const std::string& text, double* values, int count)
+{
+    std::stringstream stream(text);
+    std::string item;
+    int found = 0;
+    while (std::getline(stream, item, ','))
+    {
+        char* end = nullptr;
+        if (found == count || item.empty())
+        {
+            return false;
+        }
+        values[found++] = std::strtod(item.c_str(), &end);
+        if (*end != '\0')
+        {
+            return false;
+        }
+    }
+    return found == count;
+}
+
+/**
+ * Applies command line style options to a job.
+ *
+ * @param args options and their values
+ * @param job receives the options, fields not mentioned keep their value
+ * @param jobsFile receives the --jobs argument if present
+ * @param error receives a message if an option is invalid
+ *
+ */
+bool parseArguments(const std::vector<std::string>& args, Job& job, std::string& jobsFile, std::string& error)
+{
+    for (std::size_t k = 0; k < args.size(); ++k)
+    {
+        const std::string& option = args[k];
+        const bool hasValue = k + 1 < args.size();
+        const std::string value = hasValue ? args[k + 1] : std::string();
+        bool valid = true;
+        bool consumed = true;
+
+        if (option == "--mariani")
+        {
+            job.options.algorithm = omp::Algorithm::MARIANI_SILVER;
+            consumed = false;
+        }
+        else if (option == "--poster")
+        {
+            job.poster = true;
+            consumed = false;
+        }
+        else if (option == "--cardioid")
+        {
+            job.options.interior.cardioid = true;
+            consumed = false;
+        }
+        else if (option == "--smooth")
+        {
+            job.options.color.smooth = true;
+            consumed = false;
+        }
+        else if (option == "--histogram")
+        {
+            job.options.color.histogram = true;
+            consumed = false;
+        }
+        else if (option == "--double")
+        {
+            job.options.formula.doublePrecision = true;
+            consumed = false;
+        }
+        else if (!hasValue)
+        {
+            valid = false;
+        }
+        else if (option == "--center")
+        {
+            const std::size_t comma = value.find(',');
+            valid = comma != std::string::npos;
+            job.real = value.substr(0, comma);
+            job.imag = valid ? value.substr(comma + 1) : std::string();
+        }
+        else if (option == "--zoom")
+        {
+            job.zoom = std::atof(value.c_str());
+            valid = job.zoom > 0.0 && job.zoom <= 1.0;
+        }
+        else if (option == "--size")
+        {
+            valid = std::sscanf(value.c_str(), "%dx%d", &job.width, &job.height) == 2 && job.width > 0 && job.height > 0;
+        }
+        else if (option == "--iterations")
+        {
+            job.maxIterations = std::atoi(value.c_str());
+            valid = job.maxIterations > 0 && job.maxIterations <= 65535;  // counts are stored as uint16_t
+        }
+        else if (option == "--fractal")
+        {
+            job.fractal = value;
+            valid = value == "mandelbrot" || value == "deep";
+        }
+        else if (option == "--kernel")
+        {
+            valid = parseKernel(value, job.options.kernel);
+        }
+        else if (option == "--palette")
+        {
+            valid = omp::parsePalette(value.c_str(), job.options.color.palette);
+        }
+        else if (option == "--formula")
+        {
+            valid = omp::parseFormula(value.c_str(), job.options.formula.type);
+        }
+        else if (option == "--julia")
+        {
+            double constant[2];
+            valid = parseList(value, constant, 2);
+            job.options.formula.julia_real = constant[0];
+            job.options.formula.julia_imag = constant[1];
+        }
+        else if (option == "--band")
+        {
+            job.bandHeight = std::atoi(value.c_str());
+            valid = job.bandHeight > 0;
+        }
+        else if (option == "--animate")
+        {
+            job.animation = value;
+        }
+        else if (option == "--fps")
+        {
+            job.fps = std::atoi(value.c_str());
+            valid = job.fps > 0;
+        }
+        else if (option == "--out")
+        {
+            job.out = value;
+        }
+        else if (option == "--jobs")
+        {
+            jobsFile = value;
+        }
+        else if (option == "--pyramid")
+        {
+            job.pyramid = value;
+        }
+        else if (option == "--level")
+        {
+            job.level = std::atoi(value.c_str());
+            valid = job.level >= 0 && job.level <= omp::pyramidMaxLevel;
+        }
+        else if (option == "--region")
+        {
+            valid = parseList(value, job.region, 4);
+        }
+        else
+        {
+            error = "unknown option " + option;
+            return false;
+        }
+
+        if (!valid)
+        {
+            error = "invalid value for " + option;
+            return false;
+        }
+        k += consumed ? 1 : 0;
+    }
+    return true;
+}
+
+// Returns: why the job cannot run with its formula, empty if it can
+std::string formulaConflict(const Job& job)
+{
+    if (omp::classicFormula(job.options.formula))
+    {
+        return "";
+    }
+    if (!job.pyramid.empty())
+    {
+        return "the tile pyramid only holds the float mandelbrot formula";
+    }
+    if (job.fractal == "deep" || (job.maxIterations != 0 && job.maxIterations != omp::MAX_ITERATIONS))
+    {
+        return "perturbation and other iteration limits only exist for the float mandelbrot formula";
+    }
+    return "";
+}
+
+// Picks perturbation for views the float kernels cannot resolve and the iteration limit of the job
+bool deepJob(const Job& job, int& maxIterations)
+{
+    const bool deep = omp::classicFormula(job.options.formula) && (job.fractal == "deep" || job.zoom < FLOAT_ZOOM_LIMIT || (job.maxIterations != 0 && job.maxIterations != omp::MAX_ITERATIONS));
+    maxIterations = (job.maxIterations != 0) ? job.maxIterations : (deep ? omp::deepIterationLimit(job.zoom) : omp::MAX_ITERATIONS);
+    return deep;
+}
+
+// Parses the decimal center of a job into a deep view, the center lands in the middle of the image
+bool makeDeepView(const Job& job, int maxIterations, omp::DeepView& view)
+{
+    const int limbs = omp::FixedPoint::limbsForZoom(job.zoom);
+    omp::FixedPoint real;
+    omp::FixedPoint imag;
+    if (!omp::FixedPoint::parse(job.real, limbs, real) || !omp::FixedPoint::parse(job.imag, limbs, imag))
+    {
+        std::cerr << job.out << ": invalid center " << job.real << "," << job.imag << std::endl;
+        return false;
+    }
+    view.zoom = job.zoom;
+    view.maxIterations = maxIterations;
+    omp::centerDeepView(view, real, imag, job.width, job.height);
+    return true;
+}
+
+// Renders one image, prints its timings and adds its pixels to the totals
+bool renderJob(const Job& job, uint64_t& pixelsRendered)
+{
+    using clock = std::chrono::steady_clock;
+    const auto seconds = [](clock::time_point from, clock::time_point to) { return std::chrono::duration<double>(to - from).count(); };
+
+    int maxIterations = 0;
+    const bool deep = deepJob(job, maxIterations);
+    omp::FrameBuffer frame(job.width, job.height, job.options.color.smooth);
+    std::vector<uint32_t> pixels(std::size_t(job.width) * job.height);
+
+    const clock::time_point start = clock::now();
+    omp::PerturbationStats stats;
+    if (deep)
+    {
+        omp::DeepView view;
+        if (!makeDeepView(job, maxIterations, view))
+        {
+            return false;
+        }
+        omp::renderPerturbation(frame, view, nullptr, &stats);
+    }
+    else
+    {
+        float frame_x = 0.f;
+        float frame_y = 0.f;
+        omp::RenderOptions options = job.options;
+        omp::centerFrame(std::atof(job.real.c_str()), std::atof(job.imag.c_str()), job.width, job.height, float(job.zoom), frame_x, frame_y, options.formula);
+        omp::mandelbrotSet(frame, float(job.zoom), frame_x, frame_y, options);
+    }
+    const clock::time_point rendered = clock::now();
+
+    omp::colorize(frame, pixels.data(), maxIterations, job.options.color);
+    const clock::time_point colored = clock::now();
+
+    if (!omp::writeImage(job.out, pixels.data(), job.width, job.height))
+    {
+        std::cerr << job.out << ": could not write the image" << std::endl;
+        return false;
+    }
+    const clock::time_point written = clock::now();
+
+    pixelsRendered += uint64_t(job.width) * job.height;
+    *console << job.out << ": " << job.width << "x" << job.height << " "
+              << (deep ? "perturbation" : formulaLabel(job.options)) << ", " << maxIterations << " iterations" << std::fixed << std::setprecision(3)
+              << ", render " << seconds(start, rendered) << " s (" << job.width * double(job.height) / seconds(start, rendered) / 1e6 << " Mpixel/s)"
+              << ", color " << seconds(rendered, colored) << " s, write " << seconds(colored, written) << " s";
+    if (deep)
+    {
+        *console << ", " << stats.references << " references, " << stats.skipped << " iterations skipped";
+    }
+    *console << std::defaultfloat << std::endl;
+    return true;
+}
+
+// Streams a poster to disk band by band, resuming an interrupted run of the same job
+bool posterJob(const Job& job, uint64_t& pixelsRendered)
+{
+    omp::PosterJob poster;
+    poster.path = job.out;
+    poster.width = job.width;
+    poster.height = job.height;
+    poster.bandHeight = job.bandHeight;
+    poster.options = job.options;
+    poster.id = job.real + "," + job.imag + " " + std::to_string(job.zoom);
+    if (!omp::classicFormula(job.options.formula))
+    {
+        poster.id += " " + formulaLabel(job.options);  // a resumed poster must continue with the same formula
+    }
+    if (job.options.color != omp::ColorOptions())
+    {
+        poster.id += std::string(" ") + omp::paletteName(job.options.color.palette) + (job.options.color.smooth ? " smooth" : "");
+    }
+
+    int maxIterations = 0;
+    if (deepJob(job, maxIterations))
+    {
+        auto view = std::make_shared<omp::DeepView>();
+        if (!makeDeepView(job, maxIterations, *view))
+        {
+            return false;
+        }
+        poster.deep = view;
+    }
+    else
+    {
+        poster.zoom = float(job.zoom);
+        omp::centerFrame(std::atof(job.real.c_str()), std::atof(job.imag.c_str()), job.width, job.height, poster.zoom, poster.frame_x, poster.frame_y, poster.options.formula);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    omp::PosterStats stats;
+    const bool ok = omp::renderPoster(poster, &stats);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok)
+    {
+        std::cerr << job.out << ": could not write the poster, run again to continue from the last band" << std::endl;
+        return false;
+    }
+
+    const uint64_t rendered = uint64_t(job.width) * (job.height - stats.resumedRows);
+    pixelsRendered += rendered;
+    *console << job.out << ": " << job.width << "x" << job.height << " poster, " << maxIterations << " iterations, " << stats.bands << " bands";
+    if (stats.resumedRows > 0)
+    {
+        *console << " (resumed at row " << stats.resumedRows << ")";
+    }
+    *console << std::fixed << std::setprecision(3) << " in " << elapsed << " s (" << rendered / elapsed / 1e6 << " Mpixel/s), "
+              << std::setprecision(1) << stats.bufferBytes / 1048576.0 << " MiB of band buffers" << std::defaultfloat << std::endl;
+    return true;
+}
+
+// Reads "TIME RE,IM ZOOM" keyframes, empty lines and # comments are skipped
+bool readKeyframes(const std::string& path, std::vector<omp::Keyframe>& keyframes)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << path << ": could not open keyframe file" << std::endl;
+        return false;
+    }
+
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number)
+    {
+        const std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string center;
+        omp::Keyframe key;
+        bool valid = (fields >> key.time >> center >> key.zoom) && key.zoom > 0.0 && key.zoom <= 1.0;
+        const std::size_t comma = center.find(',');
+        if (valid && comma != std::string::npos)
+        {
+            const int limbs = omp::FixedPoint::limbsForZoom(key.zoom);
+            valid = omp::FixedPoint::parse(center.substr(0, comma), limbs, key.real) && omp::FixedPoint::parse(center.substr(comma + 1), limbs, key.imag);
+        }
+        if (!valid || comma == std::string::npos)
+        {
+            std::cerr << path << ":" << number << ": expected TIME RE,IM ZOOM" << std::endl;
+            return false;
+        }
+        keyframes.push_back(key);
+    }
+    return true;
+}
+
+// Renders a zoom video along the keyframes of the job
+bool animationJob(const Job& job, uint64_t& pixelsRendered)
+{
+    omp::AnimationJob animation;
+    if (!readKeyframes(job.animation, animation.keyframes))
+    {
+        return false;
+    }
+    animation.width = job.width;
+    animation.height = job.height;
+    animation.fps = job.fps;
+    animation.options = job.options;
+    const bool y4m = job.out == "-" || (job.out.size() > 4 && job.out.compare(job.out.size() - 4, 4, ".y4m") == 0);
+    animation.format = y4m ? omp::VideoFormat::Y4M : omp::VideoFormat::RGB24;
+    animation.deep = omp::classicFormula(job.options.formula) && (job.fractal == "deep" || std::any_of(animation.keyframes.begin(), animation.keyframes.end(), [](const omp::Keyframe& key) { return key.zoom < FLOAT_ZOOM_LIMIT; }));
+
+    std::ofstream file;
+    if (job.out != "-")
+    {
+        file.open(job.out, std::ios::binary);
+    }
+    std::ostream& out = (job.out == "-") ? std::cout : file;
+
+    const auto start = std::chrono::steady_clock::now();
+    omp::AnimationStats stats;
+    const bool ok = out && omp::renderAnimation(animation, out, &stats);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok)
+    {
+        std::cerr << job.out << ": could not write the animation" << std::endl;
+        return false;
+    }
+
+    pixelsRendered += uint64_t(job.width) * job.height * stats.frames;
+    *console << job.out << ": " << stats.frames << " frames of " << job.width << "x" << job.height << (animation.deep ? " perturbation" : "")
+             << std::fixed << std::setprecision(2) << " in " << elapsed << " s (" << stats.frames / elapsed << " frames/s), busy: iterate "
+             << stats.iterateSeconds << " s, colorize " << stats.colorSeconds << " s, encode " << stats.encodeSeconds << " s" << std::defaultfloat << std::endl;
+    return true;
+}
+
+// Precomputes a region of the tile pyramid
+bool pyramidJob(const Job& job)
+{
+    omp::TileStoreWriter writer;
+    if (!writer.open(job.pyramid, omp::MAX_ITERATIONS, job.options.interior))
+    {
+        std::cerr << job.pyramid << ": could not open for writing (in use, or written with other settings)" << std::endl;
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const int64_t appended = writer.precompute(job.level, job.region[0], job.region[1], job.region[2], job.region[3], job.options);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (appended < 0)
+    {
+        std::cerr << job.pyramid << ": write error" << std::endl;
+        return false;
+    }
+    *console << job.pyramid << ": level " << job.level << ", " << appended << " tiles appended in " << elapsed << " s" << std::endl;
+    return true;
+}
+
+// Reads a job file, every line that is not empty or a # comment becomes one job
+bool readJobs(const std::string& path, const Job& defaults, std::vector<Job>& jobs)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << path << ": could not open job file" << std::endl;
+        return false;
+    }
+
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number)
+    {
+        std::istringstream tokens(line);
+        std::vector<std::string> args;
+        for (std::string token; tokens >> token;)
+        {
+            args.push_back(token);
+        }
+        if (args.empty() || args[0][0] == '#')
+        {
+            continue;
+        }
+
+        Job job = defaults;
+        std::string nested;
+        std::string error;
+        if (!parseArguments(args, job, nested, error) || !nested.empty())
+        {
+            std::cerr << path << ":" << number << ": " << (error.empty() ? "job files cannot include other job files" : error) << std::endl;
+            return false;
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+}  // namespace
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (const std::string& arg : args)
+    {
+        if (arg == "-h" || arg == "--help")
+        {
+            std::cout << usage;
+            return EXIT_SUCCESS;
+        }
+    }
+
+    Job defaults;
+    std::string jobsFile;
+    std::string error;
+    if (!parseArguments(args, defaults, jobsFile, error))
+    {
+        std::cerr << error << "\n" << usage;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Job> jobs;
+    if (jobsFile.empty())
+    {
+        jobs.push_back(defaults);
+    }
+    else if (!readJobs(jobsFile, defaults, jobs))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (std::any_of(jobs.begin(), jobs.end(), [](const Job& job) { return job.out == "-"; }))
+    {
+        console = &std::cerr;
+    }
+    *console << "Rendering " << jobs.size() << " job(s) on " << omp::TileScheduler::instance().threadCount() << " threads" << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t pixels = 0;
+    int failed = 0;
+    for (const Job& job : jobs)
+    {
+        bool ok = false;
+        const std::string conflict = formulaConflict(job);
+        if (!conflict.empty())
+        {
+            std::cerr << job.out << ": " << conflict << std::endl;
+        }
+        else if (!job.pyramid.empty())
+        {
+            ok = pyramidJob(job);
+        }
+        else if (!job.animation.empty())
+        {
+            ok = animationJob(job, pixels);
+        }
+        else
+        {
+            ok = job.poster ? posterJob(job, pixels) : renderJob(job, pixels);
+        }
+        failed += ok ? 0 : 1;
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    *console << std::fixed << std::setprecision(3) << jobs.size() - failed << " of " << jobs.size() << " job(s) in " << elapsed << " s, "
+              << std::setprecision(1) << jobs.size() / elapsed * 3600.0 << " jobs/hour, " << pixels / elapsed / 1e6 << " Mpixel/s" << std::endl;
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
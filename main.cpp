@@ -7,25 +7,74 @@ Description: Main program for fractal visualization via shaders and OpenMP
              Uses SFML for window handling and OpenGL for graphics
 */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
 
 #include <GL/glew.h>
 #include <SFML/Graphics.hpp>
 #include <SFML/OpenGL.hpp>
 
-#include "Shader.h"
+#include "ScaledTarget.h"
+#include "ShaderCache.h"
+#include "TextureStream.h"
 #include "WindowHandler.hpp"
 #include "Mandelbrot/mandelbrot_omp.h"
+#include "Mandelbrot/render_thread.h"
+#include "Mandelbrot/tile_store.h"
+#include "Mandelbrot/trace.h"
 
 #define WINDOW_X 600 // starting window dimensions
 #define WINDOW_Y 600
+#define PYRAMID_FILE "tiles.pyr"  // precomputed tiles, served to the tile cache if the file exists
+#define TRACE_FILE "fractal_trace.json"  // written by the trace key, open in chrome://tracing or ui.perfetto.dev
+#define SHADER_BINARY_DIR "shaders"  // linked program binaries are cached next to the shader sources
+#define WINDOW_TITLE "Fractal Visualization"
+#define FRAME_WAIT_MS 4  // longest sleep for the next CPU frame, input is polled in between
+#define OVERLAY_INTERVAL 500000000ULL  // nanoseconds between stats overlay updates
+
+// Formats the stats overlay: frame rate, average time per stage, iterations executed and input latency
+std::string overlayText(const omp::trace::Summary& summary)
+{
+    const auto average = [&](const char* scope)
+    {
+        auto runs = summary.scopes.find(scope);
+        return (runs == summary.scopes.end()) ? 0.0 : summary.milliseconds.at(scope) / runs->second;
+    };
+    const auto count = [&](const std::map<std::string, int64_t>& counts, const char* name)
+    {
+        auto value = counts.find(name);
+        return (value == counts.end()) ? int64_t(0) : value->second;
+    };
+
+    char text[256];
+    std::snprintf(text, sizeof(text), "%.1f fps | pass %.1f ms, publish %.1f ms, upload %.1f ms, draw %.1f ms | %lld tiles, %.1f Mit | cache %lld/%lld | latency %.1f ms",
+                  count(summary.scopes, "present") / std::max(summary.seconds, 1e-9), average("render pass"), average("publish"), average("upload"), average("draw"),
+                  (long long)count(summary.counts, "tiles"), count(summary.counts, "iterations") * 1e-6, (long long)count(summary.counts, "cache hits"),
+                  (long long)count(summary.counts, "cache misses"), count(summary.samples, "input to present (us)") * 1e-3);
+    std::string result = text;
+    for (const auto& thread : summary.perThread)
+    {
+        std::snprintf(text, sizeof(text), " | %s %.1f Mit", thread.first.c_str(), count(thread.second, "iterations") * 1e-6);
+        result += text;
+    }
+    return result;
+}
 
 
 int main()
 {
-    sf::Window window(sf::VideoMode(WINDOW_X, WINDOW_Y), "Fractal Visualization", sf::Style::Default, sf::ContextSettings(24, 0U, 0U, 4, 3));
+    sf::Window window(sf::VideoMode(WINDOW_X, WINDOW_Y), WINDOW_TITLE, sf::Style::Default, sf::ContextSettings(24, 0U, 0U, 4, 3));
     window.setVerticalSyncEnabled(true);
     window.setActive(true);
+#if FRACTAL_TRACING
+    omp::trace::setThreadName("main");
+#endif
 
     GLenum glewErr = glewInit();
     if (glewErr != GLEW_OK)
@@ -66,100 +115,233 @@ int main()
 
     glEnable(GL_DEPTH_TEST);
 
-    // // Create OpenGL program and init shaders
-    GLuint program_id = glCreateProgram();
+    // CPU rendered frames are streamed into a texture and drawn on the quad above
+    TextureStream frameStream;
+    ScaledTarget shaderTarget;  // shader modes draw offscreen at an adaptive resolution
+    omp::RenderThread renderThread;  // renders CPU views off the event loop
+    std::shared_ptr<omp::TileStore> pyramid = std::make_shared<omp::TileStore>();
+    if (pyramid->open(PYRAMID_FILE))
+    {
+        renderThread.tileCache().attachStore(pyramid);
+        std::cout << "Tile pyramid: " << pyramid->tileCount() << " tiles in " << PYRAMID_FILE << std::endl;
+    }
+
+    // Build one linked program per fractal mode up front, picking a mode only switches programs
+    auto shaderStart = std::chrono::steady_clock::now();
+    ShaderCache shaderCache(SHADER_BINARY_DIR);
+    const ShaderProgram* programs[] =
+    {  // indexed by FractalMode, every CPU mode draws with the texture program of OPENMP_MANDELBROT
+        shaderCache.load("mandelbrot", "shaders/shader.vert", "shaders/mandelbrot.frag"),
+        shaderCache.load("julia", "shaders/shader.vert", "shaders/julia.frag"),
+        shaderCache.load("texture", "shaders/shader.vert", "shaders/texture.frag")
+    };
+    if (std::find(std::begin(programs), std::end(programs), nullptr) != std::end(programs))
+    {
+        std::cerr << "Shader initialization failed, exiting..." << std::endl;
+        return EXIT_FAILURE;  // exit if any shader failed to compile or link
+    }
+    std::cout << "Shader programs ready in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStart).count() << " ms ("
+              << shaderCache.binariesLoaded() << " of " << std::size(programs) << " from " << SHADER_BINARY_DIR << ")" << std::endl;
 
     // Define uniforms
-    WindowState windowState(program_id, window.getSize().x, window.getSize().y);
+    WindowState windowState(window.getSize().x, window.getSize().y);
     while (windowState.windowActive)
     {
         sf::Event event;
 
-        // mode select
-        FractalMode mode;
-        bool active = false;
-        while (!active)
+        // mode select, sleeps until the next event
+        FractalMode mode = FractalMode::NONE;
+        while (mode == FractalMode::NONE && windowState.windowActive)
         {
-            while(window.pollEvent(event))
+            if (!window.waitEvent(event))
             {
-                mode = windowState.modeSelect(event);
-                if (mode != FractalMode::NONE || !windowState.windowActive)
-                {
-                    active = true;
-                    break;
-                }
+                windowState.windowActive = false;  // the window is gone
+                break;
             }
+            mode = windowState.modeSelect(event);
         }
 
-        // init structures
-        Shader vertexShader(program_id);
-        Shader fragmentShader(program_id);
-        switch (mode)
+        const ShaderProgram* program = nullptr;
+        if (mode != FractalMode::NONE)
         {
-            case FractalMode::SHADER_MANDELBROT:
-                fragmentShader.init("shaders/mandelbrot.frag", ShaderType::Fragment);
-                break;
-            case FractalMode::SHADER_JULIA:
-                fragmentShader.init("shaders/julia.frag", ShaderType::Fragment);
-                break;
-            default:
-                break;
+            program = programs[static_cast<int>(cpuMode(mode) ? FractalMode::OPENMP_MANDELBROT : mode)];
+            windowState.maxZoom = cpuMode(mode) ? WindowState::floatZoomLimit : WindowState::doubleFloatZoomLimit;
+            windowState.zoom = std::max(windowState.zoom, windowState.maxZoom);  // a shader view may be deeper than the OpenMP kernels resolve
+            windowState.useProgram(program);
         }
 
-        if (mode == FractalMode::SHADER_MANDELBROT || mode == FractalMode::SHADER_JULIA)
+        windowState.fractalView = true;
+        windowState.viewChanged = true;
+        windowState.redraw = true;
+        uint64_t inputTime = 0;      // first input the screen does not show yet, 0 if none
+        uint64_t submittedInput = 0;  // input behind the view the render thread is working on
+        omp::View submitted;
+        uint64_t overlayTime = omp::trace::now();
+        bool overlayShown = false;
+        const auto handle = [&](const sf::Event& input)
+        {
+            const bool changed = windowState.viewChanged;
+            windowState.handleEvent(input);
+            if (!changed && windowState.viewChanged && inputTime == 0)
+            {
+                inputTime = omp::trace::now();
+            }
+        };
+        while (windowState.fractalView)
         {
-            vertexShader.init("shaders/shader.vert", ShaderType::Vertex);
-            if (!(vertexShader.isValid() && fragmentShader.isValid()))
+            // sleep until something changes, while the render thread refines a view only until its next frame
+            bool woken = false;
+            if (!windowState.redraw && !windowState.viewChanged)
             {
-                std::cerr << "Shader initialization failed, exiting..." << std::endl;
-                return EXIT_FAILURE;  // exit if either shader failed during initialization
+                if (cpuMode(mode) && !renderThread.idle())
+                {
+                    renderThread.waitForFrame(std::chrono::milliseconds(FRAME_WAIT_MS));
+                }
+                else
+                {
+                    woken = window.waitEvent(event);
+                }
             }
 
-            // Attempt to link program
-            bool success = Shader::linkShaders(program_id);
-            if (!success)
             {
-                std::cerr << "Failed to link shaders, exiting..." << std::endl;
-                return EXIT_FAILURE;  // exit if failed to link shaders with program
+                // everything queued up meanwhile, a burst of scroll or mouse move events, goes into one frame
+                TRACE_SCOPE("events");
+                if (woken)
+                {
+                    handle(event);
+                }
+                while (window.pollEvent(event))
+                {
+                    handle(event);
+                }
             }
 
-            windowState.shadersInit = true;
-            windowState.updateFrameUniforms();
-            windowState.updateWindowSizeUniforms();
-            if (mode == FractalMode::OPENMP_MANDELBROT)
+            uint64_t presentedInput = 0;  // input the frame drawn below responds to
+            if (cpuMode(mode))
             {
-                vertexShader.deleteShader();
-                fragmentShader.deleteShader();
+                // a newer view cancels the render in flight, finished passes are picked up as they arrive
+                if (windowState.viewChanged)
+                {
+                    submitted = windowState.snapshot();
+                    renderThread.submit(submitted);
+                    windowState.viewChanged = false;
+                    submittedInput = (submittedInput != 0) ? submittedInput : inputTime;
+                    inputTime = 0;
+                }
+
+                std::unique_ptr<omp::Frame> frame = renderThread.takeFrame();
+                if (frame)
+                {
+                    TRACE_SCOPE("upload");
+                    const omp::View& shown = frame->view;
+                    if (submittedInput != 0 && shown.width == submitted.width && shown.height == submitted.height && shown.zoom == submitted.zoom
+                        && shown.frame_x == submitted.frame_x && shown.frame_y == submitted.frame_y && shown.deep == submitted.deep)
+                    {
+                        presentedInput = submittedInput;
+                        submittedInput = 0;
+                    }
+                    uint32_t* pixels = frameStream.map(frame->view.width, frame->view.height);
+                    if (pixels != nullptr)
+                    {
+                        std::copy(frame->pixels.begin(), frame->pixels.end(), pixels);
+                        frameStream.unmap();
+                    }
+                    renderThread.recycle(std::move(frame));
+                    windowState.redraw = true;
+                }
             }
-        }
 
-        windowState.fractalView = true;
-        while (windowState.fractalView)
-        {
-            while (window.pollEvent(event))
+            if (windowState.redraw)
             {
-                windowState.handleEvent(event);
+                windowState.redraw = false;
+                switch (mode)
+                {
+                    case FractalMode::SHADER_MANDELBROT:
+                    case FractalMode::SHADER_JULIA:
+                    {
+                        TRACE_SCOPE("draw");
+                        presentedInput = inputTime;
+                        inputTime = 0;
+                        windowState.adaptResolution(shaderTarget.fullFrameMilliseconds(), windowState.viewChanged);
+                        windowState.viewChanged = false;
+                        shaderTarget.begin(windowState.window_x, windowState.window_y, windowState.resolutionScale);
+                        glClearColor(0.2f, 0.0f, 0.2f, 1.0f);
+                        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);  // clear buffers
+                        glBindVertexArray(VAO);
+                        glUseProgram(program->id);
+                        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                        shaderTarget.end();
+
+                        // keep refining a reduced frame until the view moves again
+                        windowState.redraw = windowState.resolutionScale < windowState.idleScale();
+                        break;
+                    }
+                    case FractalMode::OPENMP_MANDELBROT:
+                    case FractalMode::OPENMP_JULIA:
+                    case FractalMode::OPENMP_MULTIBROT:
+                    case FractalMode::OPENMP_BURNING_SHIP:
+                    case FractalMode::OPENMP_TRICORN:
+                    {
+                        TRACE_SCOPE("draw");
+                        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                        glBindVertexArray(VAO);
+                        glUseProgram(program->id);
+                        frameStream.bind();
+                        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+                        break;
+                    }
+                    case FractalMode::NONE:
+                        windowState.fractalView = false;
+                        break;
+                }
+
+                {
+                    TRACE_SCOPE("present");
+                    window.display();
+                }
+                if (presentedInput != 0)
+                {
+                    TRACE_SAMPLE("input to present (us)", int64_t(omp::trace::now() - presentedInput) / 1000);
+                }
             }
 
-            switch (mode)
+            if (windowState.statsOverlay && (!overlayShown || omp::trace::now() - overlayTime >= OVERLAY_INTERVAL))
+            {
+                std::string title = overlayText(omp::trace::summarize(overlayTime));
+                if (!cpuMode(mode))
+                {
+                    title += " | scale " + std::to_string(int(std::lround(windowState.resolutionScale * 100))) + "%";
+                }
+                window.setTitle(title);
+                overlayTime = omp::trace::now();
+                overlayShown = true;
+            }
+            else if (!windowState.statsOverlay && overlayShown)
+            {
+                window.setTitle(WINDOW_TITLE);
+                overlayShown = false;
+            }
+            if (windowState.traceRequested)
             {
-                case FractalMode::SHADER_MANDELBROT:
-                case FractalMode::SHADER_JULIA:
-                    glClearColor(0.2f, 0.0f, 0.2f, 1.0f);
-                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);  // clear buffers
-                    glBindVertexArray(VAO);
-                    glUseProgram(program_id);
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-                    break;
-                case FractalMode::OPENMP_MANDELBROT:
-                    omp::display(windowState.window_x, windowState.window_y, windowState.zoom, windowState.frame_x, windowState.frame_y);
-                    break;
-                case FractalMode::NONE:
-                    windowState.fractalView = false;
-                    break;
+                windowState.traceRequested = false;
+                if (omp::trace::writeChromeTrace(TRACE_FILE))
+                {
+                    std::cout << "Trace written to " << TRACE_FILE << std::endl;
+                }
+                else
+                {
+                    std::cerr << "Failed to write " << TRACE_FILE << std::endl;
+                }
             }
-            
-            window.display();
+        }
+
+        renderThread.clear();  // stop refining a view nobody is looking at
+        if (windowState.renderOptions.tileCache)
+        {
+            omp::TileCache::Stats stats = renderThread.tileCache().stats();
+            std::cout << "Tile cache: " << stats.hits << " hits, " << stats.misses << " misses (" << stats.loaded << " from " << PYRAMID_FILE << "), " << stats.evictions << " evictions, "
+                      << stats.tiles << " tiles (" << (stats.bytes >> 20) << " MiB)" << std::endl;
         }
     }
 
@@ -167,8 +349,6 @@ int main()
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &VAO);
     glDeleteBuffers(1, &EBO);
-    glDeleteProgram(program_id);
-    program_id = 0;
 
     return EXIT_SUCCESS;
 }
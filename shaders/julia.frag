@@ -7,6 +7,13 @@ Description: OpenGL fragment shader for Julia set
 */
 
 #version 330 core
+// precise (GLSL 4.00) keeps the float-float error terms, llvmpipe and most GL 3.3 drivers expose it through gpu_shader5
+#extension GL_ARB_gpu_shader5 : enable
+#ifdef GL_ARB_gpu_shader5
+#define PRECISE precise
+#else
+#define PRECISE
+#endif
 in vec4 gl_FragCoord;
 
 out vec4 frag_color;
@@ -14,11 +21,66 @@ out vec4 frag_color;
 uniform float zoom;
 uniform float frame_x;
 uniform float frame_y;
+uniform float frame_x_lo;  // frame_x + frame_x_lo is the view center in double precision
+uniform float frame_y_lo;
+uniform bool doubleFloat;  // iterate in float-float arithmetic, set by the host once float runs out of bits
 uniform int width;   // width of window
 uniform int height;  // height of window
+uniform bool periodicityCheck;  // stop once the orbit returns to a saved point
 
 #define MAX_ITERATIONS 1000
 #define MAX_MAG 4.0
+#define PERIODICITY_TOLERANCE 1e-6
+
+// float-float (double-single) arithmetic, a value is the unevaluated sum hi + lo of a vec2
+// based on Dekker's and Knuth's exact sum/product, see the QD library by Hida, Li and Bailey
+// the error terms cancel algebraically, so they are precise or the compiler folds them away (Mesa does)
+
+vec2 quickTwoSum(float a, float b)  // requires |a| >= |b|
+{
+    PRECISE float s = a + b;
+    PRECISE float e = b - (s - a);
+    return vec2(s, e);
+}
+
+vec2 twoSum(float a, float b)
+{
+    PRECISE float s = a + b;
+    PRECISE float v = s - a;
+    PRECISE float e = (a - (s - v)) + (b - v);
+    return vec2(s, e);
+}
+
+vec2 split(float a)  // hi holds the upper 12 bits of the mantissa so products of halves are exact
+{
+    PRECISE float t = 4097.0f * a;
+    PRECISE float hi = t - (t - a);
+    PRECISE float lo = a - hi;
+    return vec2(hi, lo);
+}
+
+vec2 twoProd(float a, float b)
+{
+    PRECISE float p = a * b;
+    vec2 as = split(a);
+    vec2 bs = split(b);
+    PRECISE float e = ((as.x * bs.x - p) + as.x * bs.y + as.y * bs.x) + as.y * bs.y;
+    return vec2(p, e);
+}
+
+vec2 ffAdd(vec2 a, vec2 b)
+{
+    vec2 s = twoSum(a.x, b.x);
+    PRECISE float lo = s.y + (a.y + b.y);
+    return quickTwoSum(s.x, lo);
+}
+
+vec2 ffMul(vec2 a, vec2 b)
+{
+    vec2 p = twoProd(a.x, b.x);
+    PRECISE float lo = p.y + (a.x * b.y + a.y * b.x);
+    return quickTwoSum(p.x, lo);
+}
 
 
 int calcIterations()
@@ -29,6 +91,11 @@ int calcIterations()
     int iterations = 0;
     float xc = .355534;
     float yc = -0.337292;
+
+    // Brent's scheme: z is saved at iterations 1, 2, 4, 8, ... and a bounded orbit eventually revisits it
+    float x_check = x;
+    float y_check = y;
+    int checkpoint = 1;
  
     while (iterations < MAX_ITERATIONS)
     {
@@ -42,12 +109,75 @@ int calcIterations()
         {
             return iterations;
         }
+
+        if (periodicityCheck)
+        {
+            if (abs(x - x_check) < PERIODICITY_TOLERANCE && abs(y - y_check) < PERIODICITY_TOLERANCE)
+            {
+                return MAX_ITERATIONS;
+            }
+            if (iterations == checkpoint)
+            {
+                x_check = x;
+                y_check = y;
+                checkpoint *= 2;
+            }
+        }
  
         ++iterations;
     }
 
     return iterations;
 }
+
+// Same loop as calcIterations with the coordinates and z in float-float
+int calcIterationsDoubleFloat()
+{
+    vec2 x = ffMul(ffAdd(vec2(frame_x, frame_x_lo), vec2((gl_FragCoord.x / float(width) - 0.5f) * zoom, 0.0f)), vec2(5.0f, 0.0f));
+    vec2 y = ffMul(ffAdd(vec2(frame_y, frame_y_lo), vec2((gl_FragCoord.y / float(height) - 0.5f) * zoom, 0.0f)), vec2(5.0f, 0.0f));
+
+    int iterations = 0;
+    vec2 xc = vec2(.355534, 0.0f);
+    vec2 yc = vec2(-0.337292, 0.0f);
+
+    // the tolerance follows the pixel size, a fixed one would merge distinct orbits of a deep view
+    float tolerance = PERIODICITY_TOLERANCE * zoom;
+    vec2 x_check = x;
+    vec2 y_check = y;
+    int checkpoint = 1;
+
+    while (iterations < MAX_ITERATIONS)
+    {
+        vec2 xy = ffMul(x, y);
+        x = ffAdd(ffAdd(ffMul(x, x), -ffMul(y, y)), xc);
+        y = ffAdd(ffAdd(xy, xy), yc);
+
+        float mag_sq = x.x * x.x + y.x * y.x;
+
+        if (mag_sq > MAX_MAG)
+        {
+            return iterations;
+        }
+
+        if (periodicityCheck)
+        {
+            if (abs(ffAdd(x, -x_check).x) < tolerance && abs(ffAdd(y, -y_check).x) < tolerance)
+            {
+                return MAX_ITERATIONS;
+            }
+            if (iterations == checkpoint)
+            {
+                x_check = x;
+                y_check = y;
+                checkpoint *= 2;
+            }
+        }
+
+        ++iterations;
+    }
+
+    return iterations;
+}
  
 vec4 calcColor(int iterations)
 {
@@ -63,6 +193,6 @@ vec4 calcColor(int iterations)
  
 void main()
 {
-    int iterations = calcIterations();
+    int iterations = doubleFloat ? calcIterationsDoubleFloat() : calcIterations();
     frag_color = calcColor(iterations);
 }
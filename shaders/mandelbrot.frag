@@ -7,6 +7,13 @@ Description: OpenGL fragment shader for Mandelbrot set
 */
 
 #version 330 core
+// precise (GLSL 4.00) keeps the float-float error terms, llvmpipe and most GL 3.3 drivers expose it through gpu_shader5
+#extension GL_ARB_gpu_shader5 : enable
+#ifdef GL_ARB_gpu_shader5
+#define PRECISE precise
+#else
+#define PRECISE
+#endif
 in vec4 gl_FragCoord;
 
 out vec4 frag_color;
@@ -14,14 +21,70 @@ out vec4 frag_color;
 uniform float zoom;
 uniform float frame_x;
 uniform float frame_y;
+uniform float frame_x_lo;  // frame_x + frame_x_lo is the view center in double precision
+uniform float frame_y_lo;
+uniform bool doubleFloat;  // iterate in float-float arithmetic, set by the host once float runs out of bits
 uniform int width;   // width of window
 uniform int height;  // height of window
+uniform bool cardioidCheck;     // skip points inside the main cardioid and period-2 bulb
+uniform bool periodicityCheck;  // stop once the orbit returns to a saved point
 
 // mainly code from:
 // https://physicspython.wordpress.com/2020/02/16/visualizing-the-mandelbrot-set-using-opengl-part-1/
 
 #define MAX_ITERATIONS 1000
 #define MAX_MAG 4.0
+#define PERIODICITY_TOLERANCE 1e-6
+
+// float-float (double-single) arithmetic, a value is the unevaluated sum hi + lo of a vec2
+// based on Dekker's and Knuth's exact sum/product, see the QD library by Hida, Li and Bailey
+// the error terms cancel algebraically, so they are precise or the compiler folds them away (Mesa does)
+
+vec2 quickTwoSum(float a, float b)  // requires |a| >= |b|
+{
+    PRECISE float s = a + b;
+    PRECISE float e = b - (s - a);
+    return vec2(s, e);
+}
+
+vec2 twoSum(float a, float b)
+{
+    PRECISE float s = a + b;
+    PRECISE float v = s - a;
+    PRECISE float e = (a - (s - v)) + (b - v);
+    return vec2(s, e);
+}
+
+vec2 split(float a)  // hi holds the upper 12 bits of the mantissa so products of halves are exact
+{
+    PRECISE float t = 4097.0f * a;
+    PRECISE float hi = t - (t - a);
+    PRECISE float lo = a - hi;
+    return vec2(hi, lo);
+}
+
+vec2 twoProd(float a, float b)
+{
+    PRECISE float p = a * b;
+    vec2 as = split(a);
+    vec2 bs = split(b);
+    PRECISE float e = ((as.x * bs.x - p) + as.x * bs.y + as.y * bs.x) + as.y * bs.y;
+    return vec2(p, e);
+}
+
+vec2 ffAdd(vec2 a, vec2 b)
+{
+    vec2 s = twoSum(a.x, b.x);
+    PRECISE float lo = s.y + (a.y + b.y);
+    return quickTwoSum(s.x, lo);
+}
+
+vec2 ffMul(vec2 a, vec2 b)
+{
+    vec2 p = twoProd(a.x, b.x);
+    PRECISE float lo = p.y + (a.x * b.y + a.y * b.x);
+    return quickTwoSum(p.x, lo);
+}
 
 
 int calcIterations()
@@ -32,6 +95,21 @@ int calcIterations()
     int iterations = 0;
     float xc = x;
     float yc = y;
+
+    if (cardioidCheck)
+    {
+        float xq = x - 0.25f;
+        float q = xq * xq + y * y;
+        if (q * (q + xq) <= 0.25f * y * y || (x + 1.0f) * (x + 1.0f) + y * y <= 0.0625f)
+        {
+            return MAX_ITERATIONS;
+        }
+    }
+
+    // Brent's scheme: z is saved at iterations 1, 2, 4, 8, ... and a bounded orbit eventually revisits it
+    float x_check = 0.0f;
+    float y_check = 0.0f;
+    int checkpoint = 1;
  
     while (iterations < MAX_ITERATIONS)
     {
@@ -45,12 +123,86 @@ int calcIterations()
         {
             return iterations;
         }
+
+        if (periodicityCheck)
+        {
+            if (abs(x - x_check) < PERIODICITY_TOLERANCE && abs(y - y_check) < PERIODICITY_TOLERANCE)
+            {
+                return MAX_ITERATIONS;
+            }
+            if (iterations == checkpoint)
+            {
+                x_check = x;
+                y_check = y;
+                checkpoint *= 2;
+            }
+        }
  
         ++iterations;
     }
 
     return iterations;
 }
+
+// Same loop as calcIterations with the coordinates and z in float-float
+int calcIterationsDoubleFloat()
+{
+    vec2 x = ffMul(ffAdd(vec2(frame_x, frame_x_lo), vec2((gl_FragCoord.x / float(width) - 0.5f) * zoom, 0.0f)), vec2(5.0f, 0.0f));
+    vec2 y = ffMul(ffAdd(vec2(frame_y, frame_y_lo), vec2((gl_FragCoord.y / float(height) - 0.5f) * zoom, 0.0f)), vec2(5.0f, 0.0f));
+
+    int iterations = 0;
+    vec2 xc = x;
+    vec2 yc = y;
+
+    if (cardioidCheck)
+    {
+        // hi parts only, just pixels within float rounding of the boundary can be misclassified
+        float xq = x.x - 0.25f;
+        float q = xq * xq + y.x * y.x;
+        if (q * (q + xq) <= 0.25f * y.x * y.x || (x.x + 1.0f) * (x.x + 1.0f) + y.x * y.x <= 0.0625f)
+        {
+            return MAX_ITERATIONS;
+        }
+    }
+
+    // the tolerance follows the pixel size, a fixed one would merge distinct orbits of a deep view
+    float tolerance = PERIODICITY_TOLERANCE * zoom;
+    vec2 x_check = vec2(0.0f);
+    vec2 y_check = vec2(0.0f);
+    int checkpoint = 1;
+
+    while (iterations < MAX_ITERATIONS)
+    {
+        vec2 xy = ffMul(x, y);
+        x = ffAdd(ffAdd(ffMul(x, x), -ffMul(y, y)), xc);
+        y = ffAdd(ffAdd(xy, xy), yc);
+
+        float mag_sq = x.x * x.x + y.x * y.x;
+
+        if (mag_sq > MAX_MAG)
+        {
+            return iterations;
+        }
+
+        if (periodicityCheck)
+        {
+            if (abs(ffAdd(x, -x_check).x) < tolerance && abs(ffAdd(y, -y_check).x) < tolerance)
+            {
+                return MAX_ITERATIONS;
+            }
+            if (iterations == checkpoint)
+            {
+                x_check = x;
+                y_check = y;
+                checkpoint *= 2;
+            }
+        }
+
+        ++iterations;
+    }
+
+    return iterations;
+}
  
 vec4 calcColor(int iterations)
 {
@@ -66,6 +218,6 @@ vec4 calcColor(int iterations)
  
 void main()
 {
-    int iterations = calcIterations();
+    int iterations = doubleFloat ? calcIterationsDoubleFloat() : calcIterations();
     frag_color = calcColor(iterations);
 }
@@ -0,0 +1,17 @@
+/* 
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26 
+ 
+Description: OpenGL fragment shader for the faces of the Sierpinski tetrahedron
+*/
+
+#version 330 core
+in vec3 vertex_color;
+
+out vec4 frag_color;
+
+void main()
+{
+    frag_color = vec4(vertex_color, 1.0);
+}
@@ -0,0 +1,24 @@
+/* 
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26 
+ 
+Description: OpenGL vertex shader that places one instance of the base tetrahedron per leaf of the Sierpinski tetrahedron
+*/
+
+#version 330 core
+layout (location = 0) in vec3 pos;     // vertex of the base tetrahedron
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec3 offset;  // per instance: where the leaf sits
+
+out vec3 vertex_color;
+
+uniform float scale;      // leaf size relative to the base tetrahedron, 2^-level
+uniform mat4 projection;  // fixed-function matrices of the GLUT window
+uniform mat4 modelview;
+
+void main()
+{
+    gl_Position = projection * modelview * vec4(pos * scale + offset, 1.0);
+    vertex_color = color;
+}
@@ -0,0 +1,20 @@
+/* 
+Author: James Springer & Jackson Crandell
+Class: ECE 4122
+Last Date Modified: 10/17/26 
+ 
+Description: OpenGL fragment shader that presents a CPU rendered frame
+*/
+
+#version 330 core
+in vec4 gl_FragCoord;
+
+out vec4 frag_color;
+
+uniform sampler2D frame;  // row 0 is the top of the frame
+
+void main()
+{
+    ivec2 size = textureSize(frame, 0);
+    frag_color = texelFetch(frame, ivec2(int(gl_FragCoord.x), size.y - 1 - int(gl_FragCoord.y)), 0);
+}